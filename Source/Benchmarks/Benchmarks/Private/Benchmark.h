@@ -0,0 +1,166 @@
+#pragma once
+
+#include "Core/Core.h"
+#include <numeric>
+#include <iostream>
+
+namespace Bench {
+
+    struct Result
+    {
+        std::string name;
+        uint64_t size = 0;       // the parameter of the case, elements, bindings, bytes...
+        uint64_t operations = 0; // per repetition
+        uint64_t bytes = 0;      // per operation, 0 when throughput is meaningless
+        uint32_t repetitions = 0;
+
+        // per operation
+        double minNs = 0.0;
+        double medianNs = 0.0;
+        double meanNs = 0.0;
+        double maxNs = 0.0;
+    };
+
+    struct Context
+    {
+        std::vector<Result> results;
+        std::string filter;
+        uint32_t repetitions = 15;
+    };
+
+    // side effect the optimizer can not drop
+    inline volatile uint64_t g_Sink = 0;
+    inline void Consume(uint64_t value) { g_Sink = g_Sink + value; }
+    inline void Consume(const void* ptr) { Consume(uint64_t(uintptr_t(ptr))); }
+
+    // 'body' performs 'operations' operations, it runs once untimed then 'repetitions' times timed
+    template<typename Body>
+    inline void Run(Context& ctx, std::string_view name, uint64_t size, uint64_t operations, uint64_t bytes, Body&& body)
+    {
+        if (!ctx.filter.empty() && name.find(ctx.filter) == std::string_view::npos)
+            return;
+
+        body();
+
+        std::vector<double> samples(std::max(ctx.repetitions, 1u));
+        for (auto& sample : samples)
+        {
+            const uint64_t start = Profiler::GetTicks();
+            body();
+            sample = Profiler::TicksToMilliseconds(Profiler::GetTicks() - start) * 1e6 / double(operations);
+        }
+
+        std::sort(samples.begin(), samples.end());
+
+        Result result;
+        result.name = name;
+        result.size = size;
+        result.operations = operations;
+        result.bytes = bytes;
+        result.repetitions = uint32_t(samples.size());
+        result.minNs = samples.front();
+        result.medianNs = samples[samples.size() / 2];
+        result.meanNs = std::accumulate(samples.begin(), samples.end(), 0.0) / double(samples.size());
+        result.maxNs = samples.back();
+
+        std::cout << std::format("{:<40} {:>10} {:>12.2f} {:>12.2f} {:>12.2f}\n", result.name, result.size, result.minNs, result.medianNs, result.maxNs);
+
+        ctx.results.push_back(std::move(result));
+    }
+
+    template<typename Body>
+    inline void Run(Context& ctx, std::string_view name, uint64_t size, uint64_t operations, Body&& body)
+    {
+        Run(ctx, name, size, operations, 0, std::forward<Body>(body));
+    }
+
+    inline double Throughput(const Result& r) { return r.bytes && r.medianNs > 0.0 ? double(r.bytes) / r.medianNs * 1e9 : 0.0; } // bytes/s
+
+    // case names may contain quotes, backslashes and commas ("Jops/ParallelFor(Validate,CacheLine)")
+    inline std::string EscapeJson(std::string_view str)
+    {
+        std::string result;
+        result.reserve(str.size());
+
+        for (char c : str)
+        {
+            switch (c)
+            {
+            case '"':  result += "\\\""; break;
+            case '\\': result += "\\\\"; break;
+            case '\n': result += "\\n"; break;
+            case '\t': result += "\\t"; break;
+            default:
+                if ((uint8_t)c < 0x20)
+                    result += std::format("\\u{:04x}", (uint8_t)c);
+                else
+                    result += c;
+            }
+        }
+
+        return result;
+    }
+
+    // RFC 4180, fields with a comma, a quote or a line break are quoted and their quotes doubled
+    inline std::string EscapeCsv(std::string_view str)
+    {
+        if (str.find_first_of(",\"\r\n") == std::string_view::npos)
+            return std::string(str);
+
+        std::string result = "\"";
+        for (char c : str)
+        {
+            if (c == '"')
+                result += '"';
+            result += c;
+        }
+        result += '"';
+
+        return result;
+    }
+
+    inline bool WriteJson(const Context& ctx, const std::filesystem::path& filePath)
+    {
+        std::ofstream file(filePath);
+        if (!file.is_open())
+        {
+            LOG_ERROR("Unable to open file for writing, {}", filePath.string());
+            return false;
+        }
+
+        file << "{\n";
+        file << std::format("\"clock\" : \"{}\",\n", Profiler::IsUsingTSC() ? "tsc" : "monotonic");
+        file << "\"results\" : [\n";
+
+        for (size_t i = 0; i < ctx.results.size(); i++)
+        {
+            const auto& r = ctx.results[i];
+            file << std::format(
+                "  {{ \"name\" : \"{}\", \"size\" : {}, \"operations\" : {}, \"repetitions\" : {}, \"minNs\" : {:.3f}, \"medianNs\" : {:.3f}, \"meanNs\" : {:.3f}, \"maxNs\" : {:.3f}, \"bytesPerSecond\" : {:.0f} }}{}\n",
+                EscapeJson(r.name), r.size, r.operations, r.repetitions, r.minNs, r.medianNs, r.meanNs, r.maxNs, Throughput(r),
+                i + 1 < ctx.results.size() ? "," : ""
+            );
+        }
+
+        file << "]\n}\n";
+
+        return file.good();
+    }
+
+    inline bool WriteCsv(const Context& ctx, const std::filesystem::path& filePath)
+    {
+        std::ofstream file(filePath);
+        if (!file.is_open())
+        {
+            LOG_ERROR("Unable to open file for writing, {}", filePath.string());
+            return false;
+        }
+
+        file << "name,size,operations,repetitions,minNs,medianNs,meanNs,maxNs,bytesPerSecond\n";
+
+        for (const auto& r : ctx.results)
+            file << std::format("{},{},{},{},{:.3f},{:.3f},{:.3f},{:.3f},{:.0f}\n", EscapeCsv(r.name), r.size, r.operations, r.repetitions, r.minNs, r.medianNs, r.meanNs, r.maxNs, Throughput(r));
+
+        return file.good();
+    }
+}
@@ -0,0 +1,303 @@
+#include "Benchmark.h"
+#include "Json.h"
+
+
+namespace Benchmarks {
+
+    void MetaLookups(Bench::Context& ctx)
+    {
+        constexpr uint64_t c_Lookups = 10000;
+
+        const auto& registry = Meta::Sandbox::Registry();
+
+        // linear search, the cost grows with the position of the type in the registry
+        for (uint32_t i = 0; i < registry.typeCount; i++)
+        {
+            const auto& typeName = registry.types[i].typeName;
+
+            Bench::Run(ctx, "Meta/GetType", i, c_Lookups, [&]() {
+                for (uint64_t j = 0; j < c_Lookups; j++)
+                    Bench::Consume(registry.GetType(typeName));
+            });
+        }
+
+        Bench::Run(ctx, "Meta/GetType/Miss", registry.typeCount, c_Lookups, [&]() {
+            for (uint64_t j = 0; j < c_Lookups; j++)
+                Bench::Consume(registry.GetType("Sandbox::Missing"));
+        });
+
+        Bench::Run(ctx, "Meta/Type<Entity>", 0, c_Lookups, [&]() {
+            for (uint64_t j = 0; j < c_Lookups; j++)
+                Bench::Consume(Meta::Sandbox::Type<Sandbox::Entity>());
+        });
+
+        Bench::Run(ctx, "Meta/Type<Camera>", 0, c_Lookups, [&]() {
+            for (uint64_t j = 0; j < c_Lookups; j++)
+                Bench::Consume(Meta::Sandbox::Type<Sandbox::Camera>());
+        });
+    }
+
+    void JsonWrite(Bench::Context& ctx)
+    {
+        for (uint64_t count : { 1, 64, 4096 })
+        {
+            std::vector<Sandbox::Camera> cameras(count);
+            for (auto& camera : cameras)
+                camera = { 60.0f, true, Sandbox::Projection::Perspective, { { 1.0f, 2.0f, 3.0f }, { 0.0f, 90.0f, 0.0f } } };
+
+            // serialization only, the file is never opened
+            Json::JsonWriter writer;
+
+            Bench::Run(ctx, "Json/WriteType<Camera>", count, count, [&]() {
+                writer.out.str({});
+                writer.out.clear();
+                writer.count = 0;
+
+                for (auto& camera : cameras)
+                    Json::WriteType(writer, camera);
+
+                Bench::Consume(uint64_t(writer.out.tellp()));
+            });
+        }
+    }
+
+    void KeyBindings(Bench::Context& ctx)
+    {
+        auto& keyBindings = Core::Input::GetKeyBindings();
+
+        for (uint64_t count : { 16, 256, 4096 })
+        {
+            keyBindings.clear();
+
+            std::vector<std::string> names(count);
+            for (uint64_t i = 0; i < count; i++)
+            {
+                names[i] = std::format("Action{}", i);
+
+                Core::Input::RegisterKeyBinding({
+                    .name = names[i],
+                    .modifiers = {},
+                    .code = uint16_t(Core::Key::A + i % 26),
+                    .eventType = Core::EventType::KeyPressed,
+                    .eventCategory = Core::EventCategory::Keyboard,
+                    .shortCut = "Ctrl+A",
+                });
+            }
+
+            Bench::Run(ctx, "Input/GetShortCut", count, count, [&]() {
+                for (const auto& name : names)
+                    Bench::Consume(Core::Input::GetShortCut(name).size());
+            });
+        }
+
+        keyBindings.clear();
+    }
+
+    static Jops::Task<> HopToWorker(std::atomic<uint64_t>& counter)
+    {
+        co_await Jops::ResumeOnWorker();
+        counter.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void JopsSubmission(Bench::Context& ctx)
+    {
+        for (uint64_t count : { 64, 1024, 16384 })
+        {
+            std::atomic<uint64_t> counter = 0;
+
+            Bench::Run(ctx, "Jops/SubmitTask", count, count, [&]() {
+                for (uint64_t i = 0; i < count; i++)
+                    Jops::SubmitTask([&counter]() { counter.fetch_add(1, std::memory_order_relaxed); });
+
+                Jops::WaitForAll();
+            });
+
+            Bench::Run(ctx, "Jops/Submit", count, count, [&]() {
+                for (uint64_t i = 0; i < count; i++)
+                    Jops::Submit([&counter]() { counter.fetch_add(1, std::memory_order_relaxed); });
+
+                Jops::WaitForAll();
+            });
+
+            // frame from the pool, one Submit() per hop
+            Bench::Run(ctx, "Jops/Coroutine(ResumeOnWorker)", count, count, [&]() {
+                for (uint64_t i = 0; i < count; i++)
+                    HopToWorker(counter).Detach();
+
+                Jops::WaitForAll();
+            });
+
+            Jops::Taskflow taskflow;
+            for (uint64_t i = 0; i < count; i++)
+                taskflow.emplace([&counter]() { counter.fetch_add(1, std::memory_order_relaxed); });
+
+            Bench::Run(ctx, "Jops/RunTaskflow", count, count, [&]() {
+                Jops::RunTaskflow(taskflow).wait();
+            });
+
+            Bench::Consume(counter.load());
+        }
+    }
+
+    void ParallelPasses(Bench::Context& ctx)
+    {
+        for (uint64_t count : { 1024, 65536, 1048576 })
+        {
+            std::vector<Sandbox::Entity> entities(count);
+            for (uint64_t i = 0; i < count; i++)
+                entities[i] = { { float(i), 0.0f, 0.0f }, float(i % 11), true };
+
+            // the Range of Entity::speed, clamped in place
+            auto validate = [](Sandbox::Entity& entity) { entity.SetSpeed(entity.speed); };
+
+            Bench::Run(ctx, "Jops/Serial(Validate)", count, count, [&]() {
+                for (auto& entity : entities)
+                    validate(entity);
+            });
+
+            Bench::Run(ctx, "Jops/ParallelFor(Validate)", count, count, [&]() {
+                Jops::ParallelFor(std::span(entities), validate);
+            });
+
+            Bench::Run(ctx, "Jops/ParallelFor(Validate,CacheLine)", count, count, [&]() {
+                Jops::ParallelFor(std::span(entities), validate, Jops::Chunking::CacheLine);
+            });
+
+            Bench::Run(ctx, "Jops/ParallelReduce(Speed)", count, count, [&]() {
+                auto speed = [](const Sandbox::Entity& entity) { return double(entity.speed); };
+                Bench::Consume(uint64_t(Jops::ParallelReduce(std::span(entities), 0.0, speed, std::plus<double>())));
+            });
+        }
+    }
+
+    // memory bound, larger than the last level cache, run with each --pinning to compare placements
+    void NodeLocalPasses(Bench::Context& ctx)
+    {
+        constexpr uint64_t c_Count = 8ull << 20;
+
+        // first touched by the main thread, the pages live on its node
+        std::vector<Sandbox::Entity> entities(c_Count);
+        for (uint64_t i = 0; i < c_Count; i++)
+            entities[i] = { { float(i), 0.0f, 0.0f }, float(i % 11), true };
+
+        auto validate = [](Sandbox::Entity& entity) { entity.SetSpeed(entity.speed); };
+        auto speed = [](const Sandbox::Entity& entity) { return double(entity.speed); };
+        const uint64_t bytes = sizeof(Sandbox::Entity);
+
+        Bench::Run(ctx, "Jops/ParallelFor(Validate,AnyNode)", c_Count, c_Count, bytes, [&]() {
+            Jops::ParallelFor(std::span(entities), validate, Jops::Chunking::CacheLine);
+        });
+
+        Bench::Run(ctx, "Jops/ParallelFor(Validate,CallerNode)", c_Count, c_Count, bytes, [&]() {
+            Jops::ParallelFor(std::span(entities), validate, Jops::Chunking::CacheLine, Jops::GetCurrentNode());
+        });
+
+        Bench::Run(ctx, "Jops/ParallelReduce(Speed,AnyNode)", c_Count, c_Count, bytes, [&]() {
+            Bench::Consume(uint64_t(Jops::ParallelReduce(std::span(entities), 0.0, speed, std::plus<double>())));
+        });
+
+        Bench::Run(ctx, "Jops/ParallelReduce(Speed,CallerNode)", c_Count, c_Count, bytes, [&]() {
+            Bench::Consume(uint64_t(Jops::ParallelReduce(std::span(entities), 0.0, speed, std::plus<double>(), Jops::Chunking::Adaptive, Jops::GetCurrentNode())));
+        });
+    }
+
+    void FileReads(Bench::Context& ctx)
+    {
+        const std::filesystem::path filePath = std::filesystem::temp_directory_path() / "Benchmarks.bin";
+
+        for (uint64_t size : { 4ull << 10, 1ull << 20, 64ull << 20 })
+        {
+            {
+                std::vector<uint8_t> data(size);
+                for (uint64_t i = 0; i < size; i++)
+                    data[i] = uint8_t(i * 31);
+
+                std::ofstream file(filePath, std::ios::binary);
+                file.write((const char*)data.data(), data.size());
+            }
+
+            Bench::Run(ctx, "FileSystem/ReadBinaryFile", size, 1, size, [&]() {
+                Bench::Consume(FileSystem::ReadBinaryFile(filePath).size());
+            });
+
+            Core::Buffer buffer(size);
+
+            Bench::Run(ctx, "FileSystem/ReadBinaryFile(Buffer)", size, 1, size, [&]() {
+                Bench::Consume(FileSystem::ReadBinaryFile(filePath, buffer));
+            });
+
+            buffer.Release();
+        }
+
+        FileSystem::Delete(filePath);
+    }
+
+    void ProfilerScopes(Bench::Context& ctx)
+    {
+        constexpr uint32_t c_Scopes = 1000;
+
+        Bench::Run(ctx, "Profiler/CPUScope", 0, c_Scopes, [&]() {
+            Bench::Consume(uint64_t(Profiler::MeasureCPUScopeOverhead(c_Scopes)));
+        });
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Bench::Context ctx;
+    std::filesystem::path jsonFile;
+    std::filesystem::path csvFile;
+    Jops::ExecutorDesc executorDesc;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string_view arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--filter" && hasValue)           ctx.filter = argv[++i];
+        else if (arg == "--repetitions" && hasValue) ctx.repetitions = (uint32_t)std::stoul(argv[++i]);
+        else if (arg == "--json" && hasValue)        jsonFile = argv[++i];
+        else if (arg == "--csv" && hasValue)         csvFile = argv[++i];
+        else if (arg == "--pinning" && hasValue)     executorDesc.pinning = magic_enum::enum_cast<Jops::Pinning>(argv[++i], magic_enum::case_insensitive).value_or(Jops::Pinning::None);
+        else if (arg == "--smt")                     executorDesc.skipSMTSiblings = false;
+        else
+        {
+            std::cout << "usage : Benchmarks [--filter <name>] [--repetitions <count>] [--json <file>] [--csv <file>] [--pinning none|node|core] [--smt]\n";
+            return 1;
+        }
+    }
+
+    // no window and no device, only what the benchmarked paths need
+    Application::ApplicationDesc desc;
+    desc.commandLineArgs = { argv, argc };
+    desc.headless = true;
+    desc.logFile = "Benchmarks";
+    desc.executorDesc = executorDesc;
+    desc.executorDesc.pinMainThread = executorDesc.pinning != Jops::Pinning::None;
+
+    auto app = std::make_unique<Application::ApplicationContext>(desc);
+
+    std::cout << std::format("workers {}, NUMA nodes {}, pinning {}\n", Jops::GetExecutor().num_workers(), Jops::GetNodeCount(), magic_enum::enum_name(executorDesc.pinning));
+    std::cout << std::format("{:<40} {:>10} {:>12} {:>12} {:>12}\n", "name", "size", "min ns/op", "median ns/op", "max ns/op");
+
+    Benchmarks::MetaLookups(ctx);
+    Benchmarks::JsonWrite(ctx);
+    Benchmarks::KeyBindings(ctx);
+    Benchmarks::JopsSubmission(ctx);
+    Benchmarks::ParallelPasses(ctx);
+    Benchmarks::NodeLocalPasses(ctx);
+    Benchmarks::FileReads(ctx);
+    Benchmarks::ProfilerScopes(ctx);
+
+    bool succeeded = true;
+
+    if (!jsonFile.empty())
+        succeeded &= Bench::WriteJson(ctx, jsonFile);
+
+    if (!csvFile.empty())
+        succeeded &= Bench::WriteCsv(ctx, csvFile);
+
+    app.reset();
+
+    return succeeded ? 0 : 1;
+}
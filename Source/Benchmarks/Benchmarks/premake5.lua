@@ -0,0 +1,26 @@
+project "Benchmarks"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++latest"
+    staticruntime "off"
+    debugdir "%{wks.location}"
+    targetdir (binOutputDir)
+    objdir (IntermediatesOutputDir)
+
+    Link.Runtime.Core()
+
+    -- the reflected types and the JSON writer come from Sandbox, its header tool run generates the Meta.cpp built here
+    dependson { "Sandbox" }
+
+    includedirs {
+
+        "%{wks.location}/Source/Editor/Sandbox/Private",
+    }
+
+    files {
+
+        "Private/**.cpp",
+        "Private/**.h",
+        "%{wks.location}/Source/Editor/Sandbox/Private/Meta.cpp",
+        "*.lua",
+    }
@@ -4,34 +4,120 @@
 #include "Sandbox.h"
 
 
+static void s_Invoke0(void* object, void* const* args, void* ret)
+{
+    auto& self = *static_cast<Sandbox::Entity*>(object);
+    self.Reset();
+}
+
+static void s_Invoke1(void* object, void* const* args, void* ret)
+{
+    auto& self = *static_cast<Sandbox::Entity*>(object);
+    self.SetSpeed(*static_cast<std::remove_cvref_t<float>*>(args[0]));
+}
+
 static Meta::Attribute s_Attributes[] = { 
 	Meta::Attribute(), 
+    Meta::UI::Drag,
     Meta::Color(0.2f, 0.3f, 0.7f, 1.0f),
     Meta::UI::Slider,
     Meta::Range(0.0f, 5.0f),
     Meta::UI::Text,
+    Meta::Range(0.0f, 100.0f),
  
 };
 
+static constexpr Meta::EnumValue s_EnumValues[] = { 
+
+    { "Perspective", 0, 0x36b3cefdcb897f15ull },
+    { "Orthographic", 1, 0x9593786d265f6d4bull },
+    { "Fisheye", 2, 0x03c2d9f0157d599cull } 
+};
+
+static constexpr uint32_t s_EnumLookup[] = { 
+
+    0,
+    0,
+    0,
+    2,
+    3,
+    1,
+    0,
+    0 
+};
+
+static constexpr Meta::Enum s_Enums[] = { 
+
+    { "Sandbox::Projection", "Projection", 1, false, 0, 3, s_EnumValues, 0, 8, s_EnumLookup, true } 
+};
+
 static Meta::Field s_Fields[] = { 
 
-    { "Math::float3", "position", Meta::FieldType::Float3, 12, 0, 1, 1, s_Attributes },
-    { "float", "speed", Meta::FieldType::Float, 4, 12, 2, 2, s_Attributes },
-    { "bool", "enabled", Meta::FieldType::Bool, 1, 16, 4, 1, s_Attributes },
-    { "float", "fov", Meta::FieldType::Float, 4, 0, 0, 1, s_Attributes },
-    { "bool", "isMain", Meta::FieldType::Bool, 1, 4, 0, 1, s_Attributes } 
+    { "Math::float3", "position", Meta::FieldType::Float3, 12, 0, 0, 1, s_Attributes, 0 },
+    { "Math::float3", "rotation", Meta::FieldType::Float3, 12, 12, 1, 1, s_Attributes, 0 },
+    { "Math::float3", "position", Meta::FieldType::Float3, 12, 0, 2, 1, s_Attributes, 0 },
+    { "float", "speed", Meta::FieldType::Float, 4, 12, 3, 2, s_Attributes, 0 },
+    { "bool", "enabled", Meta::FieldType::Bool, 1, 16, 5, 1, s_Attributes, 0 },
+    { "Math::float3", "position", Meta::FieldType::Float3, 12, Meta::BaseOffset<Sandbox::Player, Sandbox::Entity>() + 0, 2, 1, s_Attributes, 0 },
+    { "float", "speed", Meta::FieldType::Float, 4, Meta::BaseOffset<Sandbox::Player, Sandbox::Entity>() + 12, 3, 2, s_Attributes, 0 },
+    { "bool", "enabled", Meta::FieldType::Bool, 1, Meta::BaseOffset<Sandbox::Player, Sandbox::Entity>() + 16, 5, 1, s_Attributes, 0 },
+    { "float", "health", Meta::FieldType::Float, 4, 20, 6, 1, s_Attributes, 0 },
+    { "float", "fov", Meta::FieldType::Float, 4, 0, 0, 1, s_Attributes, 0 },
+    { "bool", "isMain", Meta::FieldType::Bool, 1, 4, 0, 1, s_Attributes, 0 },
+    { "Projection", "projection", Meta::FieldType::Enum, 1, 5, 0, 1, s_Attributes, 0 },
+    { "Transform", "transform", Meta::FieldType::Struct, 24, 8, 0, 1, s_Attributes, 0 } 
+};
+
+static Meta::Field s_FlatFields[] = { 
+
+    { "Math::float3", "position", Meta::FieldType::Float3, 12, 0, 0, 1, s_Attributes, 0 },
+    { "Math::float3", "rotation", Meta::FieldType::Float3, 12, 12, 1, 1, s_Attributes, 0 },
+    { "Math::float3", "position", Meta::FieldType::Float3, 12, 0, 2, 1, s_Attributes, 0 },
+    { "float", "speed", Meta::FieldType::Float, 4, 12, 3, 2, s_Attributes, 0 },
+    { "bool", "enabled", Meta::FieldType::Bool, 1, 16, 5, 1, s_Attributes, 0 },
+    { "Math::float3", "position", Meta::FieldType::Float3, 12, Meta::BaseOffset<Sandbox::Player, Sandbox::Entity>() + 0, 2, 1, s_Attributes, 0 },
+    { "float", "speed", Meta::FieldType::Float, 4, Meta::BaseOffset<Sandbox::Player, Sandbox::Entity>() + 12, 3, 2, s_Attributes, 0 },
+    { "bool", "enabled", Meta::FieldType::Bool, 1, Meta::BaseOffset<Sandbox::Player, Sandbox::Entity>() + 16, 5, 1, s_Attributes, 0 },
+    { "float", "health", Meta::FieldType::Float, 4, 20, 6, 1, s_Attributes, 0 },
+    { "float", "fov", Meta::FieldType::Float, 4, 0, 0, 1, s_Attributes, 0 },
+    { "bool", "isMain", Meta::FieldType::Bool, 1, 4, 0, 1, s_Attributes, 0 },
+    { "Projection", "projection", Meta::FieldType::Enum, 1, 5, 0, 1, s_Attributes, 0 },
+    { "Math::float3", "transform.position", Meta::FieldType::Float3, 12, 8, 0, 1, s_Attributes, 0 },
+    { "Math::float3", "transform.rotation", Meta::FieldType::Float3, 12, 20, 1, 1, s_Attributes, 0 } 
+};
+
+static Meta::Base s_Bases[] = { 
+
+    { 1, Meta::BaseOffset<Sandbox::Player, Sandbox::Entity>() } 
+};
+
+static Meta::Param s_Params[] = { 
+
+    { "float", "value", 4 } 
+};
+
+static Meta::Method s_Methods[] = { 
+
+    { "Reset", "void", 0, false, false, 0, 0, s_Params, 0, 1, s_Attributes, s_Invoke0 },
+    { "SetSpeed", "void", 0, false, false, 0, 1, s_Params, 0, 1, s_Attributes, s_Invoke1 } 
 };
 	
 static Meta::Type s_Types[] = {
 
-    { "Sandbox::Entity", "Entity", 20, 0, 3, s_Fields },
-    { "Sandbox::Camera", "Camera", 8, 3, 2, s_Fields }
+    { "Sandbox::Transform", "Transform", 24, 0, 2, s_Fields, 0, 2, s_FlatFields, s_Types, 0, 0, s_Bases, s_Enums, 0, 0, s_Methods },
+    { "Sandbox::Entity", "Entity", 20, 2, 3, s_Fields, 2, 3, s_FlatFields, s_Types, 0, 0, s_Bases, s_Enums, 0, 2, s_Methods },
+    { "Sandbox::Player", "Player", 24, 5, 4, s_Fields, 5, 4, s_FlatFields, s_Types, 0, 1, s_Bases, s_Enums, 2, 0, s_Methods },
+    { "Sandbox::Camera", "Camera", 32, 9, 4, s_Fields, 9, 5, s_FlatFields, s_Types, 1, 0, s_Bases, s_Enums, 2, 0, s_Methods }
 };
 		
 static Meta::TypeRegistry s_Registry{ 
 	s_Types     , std::size(s_Types), 
 	s_Attributes, std::size(s_Attributes),
-	s_Fields    , std::size(s_Fields) 
+	s_Fields    , std::size(s_Fields),
+	s_FlatFields, std::size(s_FlatFields),
+	s_Bases     , std::size(s_Bases),
+	s_Enums     , std::size(s_Enums),
+	s_Methods   , std::size(s_Methods)
 };
 
 const Meta::TypeRegistry& Meta::Sandbox::Registry() 
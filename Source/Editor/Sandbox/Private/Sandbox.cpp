@@ -1,207 +1,47 @@
 #include "Sandbox.h"
+#include "Json.h"
 #include "ImExtensions/ImExtra.h"
 #include "Core/EntryPoint.h"
 
 
-namespace Json {
-    
-    struct JsonWriter
-    {
-        std::ofstream file;
-        std::ostringstream out;
-        int count = 0;
-    };
-
-    template<typename T>
-    void WriteType(JsonWriter& writer, T& c)
-    {
-        const Meta::Type* type = Meta::Sandbox::Type<T>();
-
-        auto& out = writer.out;
-
-        if (writer.count)
-            out << ",\n";
-
-        out << "\"" << type->name << "\" : {";
-
-        auto size = type->fieldCount;
-        for (int i = 0; const auto & field : type->Fields())
-        {
-            switch (field.type)
-            {
-            case Meta::FieldType::None:
-                break;
-            case Meta::FieldType::Float:
-            {
-                auto v = field.Value<float>(c);
-                out << "\"" << field.name << "\" : " << v;
-                if (i != (size - 1)) out << ",";
-                break;
-            }
-            case Meta::FieldType::Float2:
-            {
-                auto v = field.Value<Math::float2>(c);
-                out << "\"" << field.name << "\" : " << v;
-                if (i != (size - 1)) out << ",";
-                break;
-            }
-            case Meta::FieldType::Float3:
-            {
-                auto v = field.Value<Math::float3>(c);
-                out << "\"" << field.name << "\" : " << v;
-                if (i != (size - 1)) out << ",";
-                break;
-            }
-            case Meta::FieldType::Float4:
-            {
-                auto v = field.Value<Math::float4>(c);
-                out << "\"" << field.name << "\" : " << v;
-                if (i != (size - 1)) out << ",";
-                break;
-            }
-            case Meta::FieldType::Uint8:
-            case Meta::FieldType::Uint16:
-            case Meta::FieldType::Uint64:
-            case Meta::FieldType::UInt:
-            {
-                auto v = field.Value<uint64_t>(c);
-                out << "\"" << field.name << "\" : " << v;
-                if (i != (size - 1)) out << ",";
-                break;
-            }
-            case Meta::FieldType::UInt2:
-            {
-                auto v = field.Value<Math::uint2>(c);
-                out << "\"" << field.name << "\" : " << v;
-                if (i != (size - 1)) out << ",";
-                break;
-            }
-            case Meta::FieldType::UInt3:
-            {
-                auto v = field.Value<Math::uint3>(c);
-                out << "\"" << field.name << "\" : " << v;
-                if (i != (size - 1)) out << ",";
-                break;
-            }
-            case Meta::FieldType::UInt4:
-            {
-                auto v = field.Value<Math::uint4>(c);
-                out << "\"" << field.name << "\" : " << v;
-                if (i != (size - 1)) out << ",";
-                break;
-            }
-            case Meta::FieldType::Int8:
-            case Meta::FieldType::Int16:
-            case Meta::FieldType::Int64:
-            case Meta::FieldType::Int:
-            {
-                auto v = field.Value<int64_t>(c);
-                out << "\"" << field.name << "\" : " << v;
-                if (i != (size - 1)) out << ",";
-                break;
-            }
-            case Meta::FieldType::Int2:
-            {
-                auto v = field.Value<Math::int2>(c);
-                out << "\"" << field.name << "\" : " << v;
-                if (i != (size - 1)) out << ",";
-                break;
-            }
-            case Meta::FieldType::Int3:
-            {
-                auto v = field.Value<Math::int3>(c);
-                out << "\"" << field.name << "\" : " << v;
-                if (i != (size - 1)) out << ",";
-                break;
-            }
-            case Meta::FieldType::Int4:
-            {
-                auto v = field.Value<Math::int4>(c);
-                out << "\"" << field.name << "\" : " << v;
-                if (i != (size - 1)) out << ",";
-                break;
-            }
-            case Meta::FieldType::Bool:
-            {
-                auto v = field.Value<bool>(c);
-                out << "\"" << field.name << "\" : " << v;
-                if (i != (size - 1)) out << ",";
-                break;
-            }
-            case Meta::FieldType::Bool2:
-            {
-                auto v = field.Value<Math::bool2>(c);
-                out << "\"" << field.name << "\" : " << v;
-                if (i != (size - 1)) out << ",";
-                break;
-            }
-            case Meta::FieldType::Bool3:
-            {
-                auto v = field.Value<Math::bool3>(c);
-                out << "\"" << field.name << "\" : " << v;
-                if (i != (size - 1)) out << ",";
-                break;
-            }
-            case Meta::FieldType::Bool4:
-            {
-                auto v = field.Value<Math::bool4>(c);
-                out << "\"" << field.name << "\" : " << v;
-                if (i != (size - 1)) out << ",";
-                break;
-            }
-            default:
-                break;
-            }
-           
-            i++;
-            writer.count++;
-        }
-
-        out << "}";
-    }
+namespace ImGui {
 
-    void BeginJson(JsonWriter& writer, const std::filesystem::path& filePath)
+    // FUNCTION()s without parameters of the type and its reflected bases show up as buttons
+    void MethodButtons(const Meta::Type* metaType, uint8_t& type)
     {
-        writer.file.open(filePath);
-        if (!writer.file.is_open())
+        for (const Meta::Method& method : metaType->Methods())
         {
-            LOG_ERROR("Unable to open file for writing, {}", filePath.string());
-            return;
+            if (method.paramCount == 0 && ImGui::Button(method.name.data(), { -1, 0 }))
+                method.Invoke(&type, nullptr);
         }
 
-        writer.out.str({});
-        writer.out.clear();
-
-        writer.out << "{\n";
+        for (const Meta::Base& base : metaType->Bases())
+            MethodButtons(metaType->BaseType(base), *(&type + base.offset));
     }
 
-    void EndJson(JsonWriter& writer)
+    void Struct(const Meta::Type* metaType, const char* label, uint8_t& type)
     {
-        if (!writer.file.is_open())
-            return;
-
-        writer.out << "\n}";
-        writer.file << writer.out.str();
-        writer.file.close();
-    }
-}
-
-namespace ImGui {
-
-    template<typename T>
-    void Struct(T& type)
-    {
-        const Meta::Type* metaType = Meta::Sandbox::Type<T>();
-
-        if (!metaType)
-            return;
-
-        if (ImField::BeginBlock(metaType->name.data()))
+        if (ImField::BeginBlock(label))
         {
             if (ImGui::BeginTable(metaType->name.data(), 2, ImGuiTableFlags_SizingFixedFit))
             {
                 for (const Meta::Field& field : metaType->Fields())
                 {
+                    // nested types get their own block, the table is resumed after it
+                    if (field.type == Meta::FieldType::Struct)
+                    {
+                        ImGui::EndTable();
+
+                        ImGui::PushID(field.name.data());
+                        Struct(metaType->ChildType(field), field.name.data(), *(&type + field.offset));
+                        ImGui::PopID();
+
+                        if (!ImGui::BeginTable(metaType->name.data(), 2, ImGuiTableFlags_SizingFixedFit))
+                            break;
+
+                        continue;
+                    }
+
                     Meta::Range range(-FLT_MAX, FLT_MAX);
                     Meta::UI ui = Meta::UI::Default;
                     Meta::Color color;
@@ -231,6 +71,33 @@ namespace ImGui {
 
                     switch (field.type)
                     {
+                    case Meta::FieldType::Enum:
+                    {
+                        const Meta::Enum* e = metaType->ChildEnum(field);
+                        auto& v = field.Value<uint8_t>(type);
+                        int64_t value = e->Read(&v);
+
+                        ImGui::TableNextRow();
+                        ImGui::TableNextColumn();
+                        ImGui::TextUnformatted(field.name.data());
+                        ImGui::TableNextColumn();
+                        ImGui::SetNextItemWidth(-1);
+                        ImGui::PushID(field.name.data());
+
+                        if (ImGui::BeginCombo("##enum", e->ToString(value).data()))
+                        {
+                            for (const Meta::EnumValue& entry : e->Values())
+                            {
+                                if (ImGui::Selectable(entry.name.data(), entry.value == value))
+                                    e->Write(&v, entry.value);
+                            }
+
+                            ImGui::EndCombo();
+                        }
+
+                        ImGui::PopID();
+                        break;
+                    }
                     case Meta::FieldType::Float:
                     {
                         auto& v = field.Value<float>(type);
@@ -339,9 +206,24 @@ namespace ImGui {
 
                 ImGui::EndTable();
             }
+
+            ImGui::PushID(&type);
+            MethodButtons(metaType, type);
+            ImGui::PopID();
         }
         ImField::EndBlock();
     }
+
+    template<typename T>
+    void Struct(T& type)
+    {
+        const Meta::Type* metaType = Meta::Sandbox::Type<T>();
+
+        if (!metaType)
+            return;
+
+        Struct(metaType, metaType->name.data(), *(uint8_t*)&type);
+    }
 }
 
 struct AppLayer : Core::Layer
@@ -350,6 +232,7 @@ struct AppLayer : Core::Layer
     nvrhi::CommandListHandle commandList;
 
     Sandbox::Entity entity;
+    Sandbox::Player player;
     Sandbox::Camera camera;
 
     void OnUpdate(const Core::FrameInfo& info) override
@@ -359,6 +242,7 @@ struct AppLayer : Core::Layer
         ImGui::Begin("Auto UI");
 
         ImGui::Struct(entity);
+        ImGui::Struct(player);
         ImGui::Struct(camera);
 
         if (ImGui::Button("Save", { -1, 0 }))
@@ -368,6 +252,7 @@ struct AppLayer : Core::Layer
             Json::BeginJson(writer, "JsonFile.json");
 
             Json::WriteType(writer, entity);
+            Json::WriteType(writer, player);
             Json::WriteType(writer, camera);
 
             Json::EndJson(writer);
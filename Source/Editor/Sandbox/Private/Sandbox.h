@@ -7,6 +7,22 @@ MetaHeader(Sandbox)
 
 namespace Sandbox {
 
+    enum class TYPE() Projection : uint8_t
+    {
+        Perspective,
+        Orthographic,
+        Fisheye,
+    };
+
+    struct TYPE() Transform
+    {
+        PROPERTY()
+        Math::float3 position;
+
+        PROPERTY(Meta::UI::Drag)
+        Math::float3 rotation;
+    };
+
     struct TYPE() Entity
     {
         PROPERTY(Meta::Color(0.2f, 0.3f, 0.7f, 1.0f))
@@ -18,6 +34,26 @@ namespace Sandbox {
         
         PROPERTY(Meta::UI::Text)
         bool enabled;
+
+        FUNCTION()
+        void Reset()
+        {
+            position = {};
+            speed = 1.0f;
+            enabled = true;
+        }
+
+        FUNCTION()
+        void SetSpeed(float value)
+        {
+            speed = std::clamp(value, 0.0f, 5.0f);
+        }
+    };
+
+    struct TYPE() Player : Entity
+    {
+        PROPERTY(Meta::Range(0.0f, 100.0f))
+        float health;
     };
 
     struct TYPE() Camera
@@ -27,6 +63,12 @@ namespace Sandbox {
 
         PROPERTY()
         bool isMain;
+
+        PROPERTY()
+        Projection projection;
+
+        PROPERTY()
+        Transform transform;
     };
 }
 
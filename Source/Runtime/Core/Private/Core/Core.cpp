@@ -31,6 +31,21 @@
 #if defined(CORE_PLATFORM_LINUX)
 #  define GLFW_EXPOSE_NATIVE_X11
 #  include <unistd.h>
+#  include <time.h>
+#  include <sys/ioctl.h>
+#  include <sys/syscall.h>
+#  include <linux/perf_event.h>
+#  include <pthread.h>
+#  include <sched.h>
+#endif
+#if defined(_M_X64) || defined(__x86_64__)
+#  if defined(_MSC_VER)
+#    include <intrin.h>
+#  else
+#    include <x86intrin.h>
+#    include <cpuid.h>
+#  endif
+#  define CORE_PROFILER_TSC 1
 #endif
 #include "GLFW/glfw3.h"
 #include "GLFW/glfw3native.h"
@@ -2548,33 +2563,551 @@ namespace Plugins {
 
 namespace Profiler {
 
-    CPUScope::CPUScope(std::string_view pName)
-        : name(pName)
-        , start(Application::GetTime())
+    struct Clock
+    {
+        bool useTSC = false;
+        double millisecondsPerTick = 1e-6; // the monotonic fallback counts nanoseconds
+        uint64_t startTicks = 0;
+    };
+
+    static bool HasInvariantTSC()
+    {
+#if CORE_PROFILER_TSC
+        // CPUID.80000007H:EDX[8], the TSC runs at a constant rate in every P/C-state and is synchronized across cores
+#if defined(_MSC_VER)
+        int regs[4] = {};
+        __cpuid(regs, 0x80000000);
+        if ((uint32_t)regs[0] < 0x80000007)
+            return false;
+
+        __cpuid(regs, 0x80000007);
+        return (regs[3] & (1 << 8)) != 0;
+#else
+        unsigned int eax, ebx, ecx, edx;
+        if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx))
+            return false;
+
+        return (edx & (1 << 8)) != 0;
+#endif
+#else
+        return false;
+#endif
+    }
+
+    static uint64_t ReadMonotonicNanoseconds()
+    {
+#if defined(CORE_PLATFORM_LINUX)
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+        return uint64_t(ts.tv_sec) * 1000000000ull + uint64_t(ts.tv_nsec);
+#else
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    static Clock CalibrateClock()
+    {
+        Clock clock;
+
+#if CORE_PROFILER_TSC
+        clock.useTSC = HasInvariantTSC();
+
+        if (clock.useTSC)
+        {
+            // spin ~10 ms against the monotonic clock, the relative error stays around 1e-6
+            const uint64_t ns0 = ReadMonotonicNanoseconds();
+            const uint64_t tsc0 = __rdtsc();
+
+            uint64_t ns1 = ns0;
+            while (ns1 - ns0 < 10'000'000)
+                ns1 = ReadMonotonicNanoseconds();
+
+            const uint64_t tsc1 = __rdtsc();
+
+            clock.millisecondsPerTick = (double(ns1 - ns0) / double(tsc1 - tsc0)) * 1e-6;
+            clock.startTicks = tsc1;
+
+            return clock;
+        }
+#endif
+
+        clock.startTicks = ReadMonotonicNanoseconds();
+
+        return clock;
+    }
+
+    // calibrated on first use, a namespace scope static would spin at load time and could be read by other static initializers before it
+    static const Clock& GetClock()
+    {
+        static const Clock s_Clock = CalibrateClock();
+        return s_Clock;
+    }
+
+    uint64_t GetTicks()
+    {
+#if CORE_PROFILER_TSC
+        if (GetClock().useTSC)
+            return __rdtsc();
+#endif
+
+        return ReadMonotonicNanoseconds();
+    }
+
+    double TicksToMilliseconds(uint64_t ticks)
+    {
+        return double(ticks) * GetClock().millisecondsPerTick;
+    }
+
+    bool IsUsingTSC()
+    {
+        return GetClock().useTSC;
+    }
+
+    static std::atomic<uint32_t> s_CPUProfilerGeneration = 0;
+
+    struct CPUThreadBufferSlot
+    {
+        uint32_t generation = 0;
+        CPUThreadBuffer* buffer = nullptr;
+    };
+
+    static thread_local CPUThreadBufferSlot t_CPUThreadBuffer;
+
+    // allocations of threads that never opened a scope, or made before the application or after it is destroyed
+    static std::atomic<uint64_t> s_UntrackedAllocations = 0;
+    static std::atomic<uint64_t> s_UntrackedAllocatedBytes = 0;
+    static std::atomic<uint64_t> s_UntrackedFrees = 0;
+
+    // registers the calling thread on first use, a restarted application owns a new set of buffers
+    static CPUThreadBuffer& GetCPUThreadBuffer()
     {
         auto& ctx = Application::GetAppContext();
 
-        index = ctx.cpuProfilerIndex;
+        if (t_CPUThreadBuffer.generation != ctx.cpuProfilerGeneration)
+        {
+            std::scoped_lock<std::mutex> lock(ctx.cpuProfilerThreadsMutex);
+
+            auto& buffer = ctx.cpuProfilerThreads.emplace_back(std::make_unique<CPUThreadBuffer>());
+            buffer->threadIndex = uint32_t(ctx.cpuProfilerThreads.size() - 1);
+            buffer->records.resize(CPUThreadBuffer::c_MaxRecords);
+            buffer->frameRecords.reserve(CPUThreadBuffer::c_MaxRecords);
+
+            int workerID = ctx.executor.this_worker_id();
+            if (workerID >= 0)
+                buffer->name = std::format("Worker {}", workerID);
+            else if (buffer->threadIndex == 0)
+                buffer->name = "Main Thread";
+            else
+                buffer->name = std::format("Thread {}", buffer->threadIndex);
 
-        if (index >= (int)ctx.cpuProfilerRecords.size())
-            ctx.cpuProfilerRecords.resize(ctx.cpuProfilerRecords.size() * 2);
+            t_CPUThreadBuffer = { ctx.cpuProfilerGeneration, buffer.get() };
+        }
 
-        auto& record = ctx.cpuProfilerRecords[index];
-        ctx.cpuProfilerIndex++;
-        record.name = name;
-        record.depth = ctx.cpuProfilerDepth;
+        return *t_CPUThreadBuffer.buffer;
+    }
+
+    // -1 when the thread already has c_MaxRecords distinct scopes
+    static int FindOrAddRecord(CPUThreadBuffer& buffer, const CPUEvent& event)
+    {
+        constexpr uint32_t c_Mask = CPUThreadBuffer::c_TableSize - 1;
+
+        for (uint32_t slot = uint32_t(event.id) & c_Mask;; slot = (slot + 1) & c_Mask)
+        {
+            const uint32_t entry = buffer.recordTable[slot];
+            if (entry == 0)
+            {
+                if (buffer.recordCount == (int)buffer.records.size())
+                    return -1;
+
+                const int index = buffer.recordCount++;
+                buffer.recordTable[slot] = index + 1;
+
+                auto& record = buffer.records[index];
+                record.name = event.name;
+                record.id = event.id;
+                record.threadIndex = buffer.threadIndex;
 
-        ctx.cpuProfilerDepth++;
+                return index;
+            }
+
+            if (buffer.records[entry - 1].id == event.id)
+                return entry - 1;
+        }
     }
 
-    CPUScope::~CPUScope()
+    static void PushSample(const Application::ApplicationContext& ctx, FrameHistory& history, float sample)
+    {
+        const float mean = history.Mean();
+        if (history.count > 0 && sample >= ctx.profilerHitchMinimum && sample > mean * ctx.profilerHitchFactor)
+            history.hitchCount++;
+
+        history.Push(sample);
+    }
+
+    // also pushes the histories and averages of the records, the buffers list grows under the lock from any thread
+    static void MergeCPUThreadBuffers(Application::ApplicationContext& ctx)
+    {
+        static std::vector<CPUEvent> s_FrameEvents;
+        if (s_FrameEvents.capacity() < CPUThreadBuffer::c_Capacity)
+            s_FrameEvents.reserve(CPUThreadBuffer::c_Capacity);
+
+        std::scoped_lock<std::mutex> lock(ctx.cpuProfilerThreadsMutex);
+
+        uint64_t allocations = s_UntrackedAllocations.exchange(0, std::memory_order_relaxed);
+        uint64_t allocatedBytes = s_UntrackedAllocatedBytes.exchange(0, std::memory_order_relaxed);
+        uint64_t frees = s_UntrackedFrees.exchange(0, std::memory_order_relaxed);
+
+        for (auto& buffer : ctx.cpuProfilerThreads)
+        {
+            const uint64_t bufferAllocations = buffer->allocations.load(std::memory_order_relaxed);
+            const uint64_t bufferAllocatedBytes = buffer->allocatedBytes.load(std::memory_order_relaxed);
+            const uint64_t bufferFrees = buffer->frees.load(std::memory_order_relaxed);
+
+            allocations += bufferAllocations - buffer->lastAllocations;
+            allocatedBytes += bufferAllocatedBytes - buffer->lastAllocatedBytes;
+            frees += bufferFrees - buffer->lastFrees;
+
+            buffer->lastAllocations = bufferAllocations;
+            buffer->lastAllocatedBytes = bufferAllocatedBytes;
+            buffer->lastFrees = bufferFrees;
+
+            s_FrameEvents.clear();
+
+            uint32_t tail = buffer->tail.load(std::memory_order_relaxed);
+            const uint32_t head = buffer->head.load(std::memory_order_acquire);
+
+            for (; tail != head; tail++)
+                s_FrameEvents.push_back(buffer->events[tail & (CPUThreadBuffer::c_Capacity - 1)]);
+
+            buffer->tail.store(tail, std::memory_order_release);
+
+            // scopes close inner first, records are listed in the order they were opened
+            std::sort(s_FrameEvents.begin(), s_FrameEvents.end(), [](const CPUEvent& a, const CPUEvent& b) {
+                return a.start != b.start ? a.start < b.start : a.depth < b.depth;
+            });
+
+            if (ctx.profilerCapturing)
+            {
+                for (const auto& event : s_FrameEvents)
+                {
+                    if (ctx.profilerCapture.size() < ctx.profilerCapture.capacity())
+                        ctx.profilerCapture.push_back({ event, buffer->threadIndex });
+                    else
+                        ctx.profilerCaptureDropped++;
+                }
+            }
+
+            for (int i = 0; i < buffer->recordCount; i++)
+            {
+                auto& record = buffer->records[i];
+                record.calls = 0;
+                record.delta = 0.0f;
+                record.allocations = 0;
+                record.allocatedBytes = 0;
+                record.counters = {};
+            }
+            buffer->frameRecords.clear();
+
+            // a scope that is skipped this frame keeps its record, the others do not shift
+            for (const auto& event : s_FrameEvents)
+            {
+                const int index = FindOrAddRecord(*buffer, event);
+                if (index < 0)
+                {
+                    buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+
+                auto& record = buffer->records[index];
+                if (record.calls++ == 0)
+                {
+                    record.depth = event.depth;
+                    buffer->frameRecords.push_back(index);
+                }
+
+                record.delta += float(TicksToMilliseconds(event.end - event.start));
+                record.allocations += event.allocations;
+                record.allocatedBytes += event.allocatedBytes;
+                record.counters += event.counters;
+                record.lastWrite = float(TicksToMilliseconds(event.end - GetClock().startTicks) * 0.001);
+            }
+
+            for (size_t i = 0; i < buffer->recordCount; i++)
+            {
+                auto& p = buffer->records[i];
+
+                if (p.calls)
+                    PushSample(ctx, p.history, p.delta);
+
+                p.timeSum += p.delta;
+                if (ctx.frameTimeSum > ctx.averageTimeUpdateInterval && ctx.numberOfAccumulatedFrames > 0)
+                {
+                    p.time = p.timeSum / ctx.numberOfAccumulatedFrames;
+                    p.timeSum = 0.0f;
+                }
+            }
+        }
+
+        ctx.appStats.allocations = uint32_t(allocations);
+        ctx.appStats.allocatedBytes = allocatedBytes;
+        ctx.appStats.frees = uint32_t(frees);
+    }
+
+    static void PushEvent(CPUThreadBuffer& buffer, const CPUEvent& event)
+    {
+        const uint32_t head = buffer.head.load(std::memory_order_relaxed);
+        if (head - buffer.tail.load(std::memory_order_acquire) >= CPUThreadBuffer::c_Capacity)
+        {
+            buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        buffer.events[head & (CPUThreadBuffer::c_Capacity - 1)] = event;
+        buffer.head.store(head + 1, std::memory_order_release);
+    }
+
+    // task names live in their taskflow, the capture may outlive it
+    static std::string_view InternTaskName(std::string_view name)
     {
         auto& ctx = Application::GetAppContext();
-        auto& record = ctx.cpuProfilerRecords[index];
-        record.delta = Application::GetTime() - start;
-        record.lastWrite = Application::GetTime();
 
-        ctx.cpuProfilerDepth--;
+        std::scoped_lock<std::mutex> lock(ctx.profilerTaskNamesMutex);
+        return *ctx.profilerTaskNames.emplace(name).first;
+    }
+
+    // Attached between BeginCapture() and EndCapture(), every task the executor runs is recorded like a CPU scope on the worker that ran it.
+    struct TaskObserver : tf::ObserverInterface
+    {
+        static constexpr std::string_view c_UnnamedTask = "Jops Task";
+        static constexpr size_t c_MaxCachedNames = 4096;
+
+        struct TaskName
+        {
+            std::string_view name;
+            uint64_t id = 0;
+        };
+
+        std::vector<std::vector<uint64_t>> starts; // per worker, tasks can nest through corun
+        std::vector<std::unordered_map<size_t, TaskName>> names; // per worker, keyed by task node
+
+        void set_up(size_t workerCount) override
+        {
+            starts.resize(workerCount);
+            for (auto& stack : starts)
+                stack.reserve(16);
+
+            names.resize(workerCount);
+        }
+
+        // interned once per task and worker instead of once per run, the name is compared again in case the node was reused by another taskflow
+        const TaskName& GetTaskName(size_t workerId, tf::TaskView task)
+        {
+            auto& cache = names[workerId];
+            const std::string& taskName = task.name();
+            const std::string_view name = taskName.empty() ? c_UnnamedTask : std::string_view(taskName);
+
+            auto it = cache.find(task.hash_value());
+            if (it != cache.end() && it->second.name == name)
+                return it->second;
+
+            if (cache.size() >= c_MaxCachedNames)
+                cache.clear();
+
+            TaskName& entry = cache[task.hash_value()];
+            entry.name = taskName.empty() ? c_UnnamedTask : InternTaskName(name);
+            entry.id = MakeScopeID(entry.name);
+
+            return entry;
+        }
+
+        void on_entry(tf::WorkerView worker, tf::TaskView task) override
+        {
+            GetCPUThreadBuffer().depth++;
+            starts[worker.id()].push_back(GetTicks());
+        }
+
+        void on_exit(tf::WorkerView worker, tf::TaskView task) override
+        {
+            auto& buffer = GetCPUThreadBuffer();
+            buffer.depth--;
+
+            auto& stack = starts[worker.id()];
+            const uint64_t start = stack.back();
+            stack.pop_back();
+
+            const TaskName& name = GetTaskName(worker.id(), task);
+            PushEvent(buffer, { name.name, name.id, start, GetTicks(), buffer.depth });
+        }
+    };
+
+    static std::atomic<bool> s_PerfCountersEnabled = false;
+
+#if defined(CORE_PLATFORM_LINUX)
+    static int OpenPerfEvent(uint64_t config, int groupFd)
+    {
+        perf_event_attr attr = {};
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = config;
+        attr.disabled = groupFd == -1; // the leader starts the whole group
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+
+        // calling thread, any CPU
+        return (int)syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0);
+    }
+#endif
+
+    static void ClosePerfCounters(CPUThreadBuffer& buffer)
+    {
+#if defined(CORE_PLATFORM_LINUX)
+        for (int& fd : buffer.perfEvents)
+        {
+            if (fd >= 0)
+                close(fd);
+            fd = -1;
+        }
+#endif
+        buffer.perfGroup = -1;
+    }
+
+    static bool OpenPerfCounters(CPUThreadBuffer& buffer)
+    {
+        buffer.perfOpened = true;
+
+#if defined(CORE_PLATFORM_LINUX)
+        constexpr uint64_t c_Configs[] = {
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES,
+            PERF_COUNT_HW_BRANCH_MISSES,
+        };
+
+        for (int i = 0; i < 4; i++)
+        {
+            buffer.perfEvents[i] = OpenPerfEvent(c_Configs[i], buffer.perfEvents[0]);
+            if (buffer.perfEvents[i] < 0)
+            {
+                // not supported by the CPU or the VM, or kernel.perf_event_paranoid is too strict
+                LOG_CORE_WARN("Profiler : perf_event_open failed on {} ({})", buffer.name, strerror(errno));
+                ClosePerfCounters(buffer);
+                return false;
+            }
+        }
+
+        buffer.perfGroup = buffer.perfEvents[0];
+        ioctl(buffer.perfGroup, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(buffer.perfGroup, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    static bool ReadPerfCounters(CPUThreadBuffer& buffer, PerfCounters& counters)
+    {
+        if (!s_PerfCountersEnabled.load(std::memory_order_relaxed))
+            return false;
+
+        if (!buffer.perfOpened)
+            OpenPerfCounters(buffer);
+
+#if defined(CORE_PLATFORM_LINUX)
+        if (buffer.perfGroup < 0)
+            return false;
+
+        // PERF_FORMAT_GROUP layout, { nr, values[nr] } in the order the events were opened
+        uint64_t data[5];
+        if (read(buffer.perfGroup, data, sizeof(data)) != sizeof(data))
+            return false;
+
+        counters = { data[1], data[2], data[3], data[4] };
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void CPUScope::Begin()
+    {
+        auto& buffer = GetCPUThreadBuffer();
+        depth = buffer.depth++;
+        parent = buffer.current;
+        buffer.current = this;
+        ReadPerfCounters(buffer, counters);
+        start = GetTicks();
+    }
+
+    CPUScope::~CPUScope()
+    {
+        const uint64_t end = GetTicks();
+
+        auto& buffer = GetCPUThreadBuffer();
+        buffer.depth--;
+        buffer.current = parent;
+
+        PerfCounters now;
+        if (ReadPerfCounters(buffer, now))
+            counters = { now.cycles - counters.cycles, now.instructions - counters.instructions, now.cacheMisses - counters.cacheMisses, now.branchMisses - counters.branchMisses };
+        else
+            counters = {};
+
+        PushEvent(buffer, { name, id, start, end, depth, allocations, allocatedBytes, counters });
+    }
+
+    // called from operator new, it must not allocate and must not register the thread
+    static CPUThreadBuffer* GetRegisteredCPUThreadBuffer()
+    {
+        if (t_CPUThreadBuffer.generation != s_CPUProfilerGeneration.load(std::memory_order_relaxed))
+            return nullptr;
+
+        return t_CPUThreadBuffer.buffer;
+    }
+
+    static std::atomic<bool> s_TrackingAllocations = false;
+
+    void SetTrackingAllocations(bool enable)
+    {
+        s_TrackingAllocations.store(enable, std::memory_order_relaxed);
+    }
+
+    bool IsTrackingAllocations()
+    {
+        return s_TrackingAllocations.load(std::memory_order_relaxed);
+    }
+
+    void TrackAllocation(uint64_t size)
+    {
+        CPUThreadBuffer* buffer = GetRegisteredCPUThreadBuffer();
+        if (!buffer)
+        {
+            s_UntrackedAllocations.fetch_add(1, std::memory_order_relaxed);
+            s_UntrackedAllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+            return;
+        }
+
+        buffer->allocations.store(buffer->allocations.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        buffer->allocatedBytes.store(buffer->allocatedBytes.load(std::memory_order_relaxed) + size, std::memory_order_relaxed);
+
+        if (buffer->current)
+        {
+            buffer->current->allocations++;
+            buffer->current->allocatedBytes += size;
+        }
+    }
+
+    void TrackFree()
+    {
+        CPUThreadBuffer* buffer = GetRegisteredCPUThreadBuffer();
+        if (!buffer)
+        {
+            s_UntrackedFrees.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        buffer->frees.store(buffer->frees.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
     }
 
     GPUScope::GPUScope(nvrhi::IDevice* pDevice, nvrhi::ICommandList* pCommandList, std::string_view pName)
@@ -2586,8 +3119,12 @@ namespace Profiler {
 
         index = (int)ctx.gpuProfilerIndex;
 
+        // the records are preallocated, scopes past the last one are not recorded
         if (index >= (int)ctx.gpuProfilerRecords.size())
-            ctx.gpuProfilerRecords.resize(ctx.gpuProfilerRecords.size() * 2);
+        {
+            index = -1;
+            return;
+        }
 
         auto& record = ctx.gpuProfilerRecords[index];
         ctx.gpuProfilerIndex++;
@@ -2607,6 +3144,9 @@ namespace Profiler {
 
     GPUScope::~GPUScope()
     {
+        if (index < 0)
+            return;
+
         auto& ctx = Application::GetAppContext();
 
         auto& record = ctx.gpuProfilerRecords[index];
@@ -2628,10 +3168,6 @@ namespace Profiler {
     {
         auto& ctx = Application::GetAppContext();
 
-        ctx.cpuProfilerRecordCount = ctx.cpuProfilerIndex;
-        ctx.cpuProfilerIndex = 0;
-        ctx.cpuProfilerDepth = 0;
-
         ctx.gpuProfilerRecordCount = ctx.gpuProfilerIndex;
         ctx.gpuProfilerIndex = 0;
         ctx.gpuProfilerDepth = 0;
@@ -2648,22 +3184,14 @@ namespace Profiler {
         ctx.frameTimeSum += ctx.frameTimestamp;
         ctx.numberOfAccumulatedFrames += 1;
 
-        for (size_t i = 0; i < ctx.cpuProfilerRecordCount; i++)
-        {
-            auto& p = ctx.cpuProfilerRecords[i];
-
-            p.timeSum += p.delta;
-            if (ctx.frameTimeSum > ctx.averageTimeUpdateInterval && ctx.numberOfAccumulatedFrames > 0)
-            {
-                p.time = (p.timeSum / ctx.numberOfAccumulatedFrames) * 1000;
-                p.timeSum = 0.0f;
-            }
-        }
+        MergeCPUThreadBuffers(ctx);
 
         for (size_t i = 0; i < ctx.gpuProfilerRecordCount; i++)
         {
             auto& p = ctx.gpuProfilerRecords[i];
 
+            PushSample(ctx, p.history, p.delta);
+
             p.timeSum += p.delta;
             if (ctx.frameTimeSum > ctx.averageTimeUpdateInterval && ctx.numberOfAccumulatedFrames > 0)
             {
@@ -2683,14 +3211,14 @@ namespace Profiler {
         }
     }
 
-    void CPUBegin(std::string_view pName)
+    void CPUBegin(std::string_view pName, std::source_location location)
     {
-        Application::GetAppContext().cpuProfilerStack.emplace(pName);
+        GetCPUThreadBuffer().stack.emplace(pName, location);
     }
 
     void CPUEnd()
     {
-        Application::GetAppContext().cpuProfilerStack.pop();
+        GetCPUThreadBuffer().stack.pop();
     }
 
     void GPUBegin(nvrhi::IDevice* pDevice, nvrhi::ICommandList* pCommandList, std::string_view pName)
@@ -2702,27 +3230,870 @@ namespace Profiler {
     {
         Application::GetAppContext().gpuProfilerStack.pop();
     }
-}
 
-//////////////////////////////////////////////////////////////////////////
-// Jops
-//////////////////////////////////////////////////////////////////////////
+    double MeasureCPUScopeOverhead(uint32_t iterations)
+    {
+        constexpr uint32_t c_BatchSize = CPUThreadBuffer::c_Capacity / 2;
+        constexpr std::string_view c_ScopeName = "Profiler Overhead";
+
+        auto& ctx = Application::GetAppContext();
+        auto& buffer = GetCPUThreadBuffer();
+
+        uint64_t ticks = 0;
+        for (uint32_t done = 0; done < iterations;)
+        {
+            const uint32_t count = std::min(c_BatchSize, iterations - done);
+
+            const uint64_t start = GetTicks();
+            for (uint32_t i = 0; i < count; i++)
+            {
+                BUILTIN_PROFILE_CPU(c_ScopeName);
+            }
+            ticks += GetTicks() - start;
+
+            // consumer side, serialized with EndFrame() through the same lock
+            {
+                std::scoped_lock<std::mutex> lock(ctx.cpuProfilerThreadsMutex);
+                buffer.tail.store(buffer.head.load(std::memory_order_acquire), std::memory_order_release);
+            }
+
+            done += count;
+        }
+
+        return iterations ? TicksToMilliseconds(ticks) * 1e6 / iterations : 0.0;
+    }
+
+    FrameStats ComputeFrameStats(const FrameHistory& history)
+    {
+        FrameStats stats;
+        stats.sampleCount = history.count;
+        stats.hitchCount = history.hitchCount;
+
+        if (history.count == 0)
+            return stats;
+
+        std::array<float, FrameHistory::c_Size> sorted;
+        std::copy_n(history.samples.begin(), history.count, sorted.begin());
+        std::sort(sorted.begin(), sorted.begin() + history.count);
+
+        // nearest rank
+        auto percentile = [&](float p) {
+            uint32_t rank = (uint32_t)std::ceil(p * history.count);
+            return sorted[std::clamp(rank, 1u, history.count) - 1];
+        };
+
+        stats.min = sorted[0];
+        stats.max = sorted[history.count - 1];
+        stats.mean = history.Mean();
+        stats.p50 = percentile(0.50f);
+        stats.p95 = percentile(0.95f);
+        stats.p99 = percentile(0.99f);
+
+        return stats;
+    }
+
+    void SetHitchThreshold(float factor, float minimumMs)
+    {
+        auto& ctx = Application::GetAppContext();
+        ctx.profilerHitchFactor = factor;
+        ctx.profilerHitchMinimum = minimumMs;
+    }
+
+    bool EnablePerfCounters(bool enable)
+    {
+        if (!enable)
+        {
+            s_PerfCountersEnabled = false;
+            return true;
+        }
+
+        // probe on the calling thread, the other threads open their group on their next scope
+        s_PerfCountersEnabled = true;
+        auto& buffer = GetCPUThreadBuffer();
+        if (!buffer.perfOpened)
+            OpenPerfCounters(buffer);
+
+        if (buffer.perfGroup < 0)
+            s_PerfCountersEnabled = false;
+
+        return s_PerfCountersEnabled;
+    }
+
+    bool IsUsingPerfCounters()
+    {
+        return s_PerfCountersEnabled;
+    }
+
+    void BeginCapture(uint32_t maxEvents)
+    {
+        auto& ctx = Application::GetAppContext();
+
+        ctx.profilerCapture.clear();
+        ctx.profilerCapture.reserve(maxEvents);
+        ctx.profilerCaptureDropped = 0;
+        ctx.profilerCapturing = true;
+
+        // the executor does not synchronize its observers with the tasks it runs
+        if (!ctx.profilerTaskObserver)
+        {
+            ctx.executor.wait_for_all();
+            ctx.profilerTaskObserver = ctx.executor.make_observer<TaskObserver>();
+        }
+    }
+
+    void EndCapture()
+    {
+        auto& ctx = Application::GetAppContext();
+
+        ctx.profilerCapturing = false;
+
+        if (ctx.profilerTaskObserver)
+        {
+            ctx.executor.wait_for_all();
+            ctx.executor.remove_observer(std::move(ctx.profilerTaskObserver));
+        }
+    }
+
+    bool IsCapturing()
+    {
+        return Application::GetAppContext().profilerCapturing;
+    }
+
+    static void WriteJsonString(std::ostream& out, std::string_view str)
+    {
+        out << '"';
+        for (char c : str)
+        {
+            switch (c)
+            {
+            case '"':  out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\t': out << "\\t"; break;
+            default:
+                if ((uint8_t)c < 0x20)
+                    out << std::format("\\u{:04x}", (uint8_t)c);
+                else
+                    out << c;
+            }
+        }
+        out << '"';
+    }
+
+    bool WriteCapture(const std::filesystem::path& filePath)
+    {
+        CORE_PROFILE_FUNCTION();
+
+        auto& ctx = Application::GetAppContext();
+
+        std::ofstream file(filePath, std::ios::binary);
+        if (!file.is_open())
+        {
+            LOG_CORE_ERROR("Profiler : unable to open {} for writing", filePath.string());
+            return false;
+        }
+
+        file << "{\"traceEvents\":[\n";
+
+        bool first = true;
+        auto separator = [&]() {
+            if (!first)
+                file << ",\n";
+            first = false;
+        };
+
+        {
+            std::scoped_lock<std::mutex> lock(ctx.cpuProfilerThreadsMutex);
+
+            for (const auto& buffer : ctx.cpuProfilerThreads)
+            {
+                separator();
+                file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadIndex << ",\"args\":{\"name\":";
+                WriteJsonString(file, buffer->name);
+                file << "}}";
+            }
+        }
+
+        // microseconds since the profiler clock started
+        auto toMicroseconds = [](uint64_t ticks) { return TicksToMilliseconds(ticks - GetClock().startTicks) * 1000.0; };
+
+        for (const auto& e : ctx.profilerCapture)
+        {
+            separator();
+            file << "{\"name\":";
+            WriteJsonString(file, e.event.name);
+            file << std::format(",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}",
+                e.threadIndex,
+                toMicroseconds(e.event.start),
+                TicksToMilliseconds(e.event.end - e.event.start) * 1000.0
+            );
+        }
+
+        file << std::format("\n],\"displayTimeUnit\":\"ms\",\"otherData\":{{\"droppedEvents\":{}}}}}\n", ctx.profilerCaptureDropped);
+
+        LOG_CORE_INFO("Profiler : wrote {} events to {}", ctx.profilerCapture.size(), filePath.string());
+
+        return file.good();
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Jops
+//////////////////////////////////////////////////////////////////////////
 
 namespace Jops {
 
-    std::future<void> SubmitTask(const std::function<void()>& function) { return Application::GetAppContext().executor.async(function); }
+    template<typename T>
+    static void AtomicMax(std::atomic<T>& target, T value)
+    {
+        T current = target.load(std::memory_order_relaxed);
+        while (current < value && !target.compare_exchange_weak(current, value, std::memory_order_relaxed));
+    }
+
+    static uint64_t OnSubmitted(QueueCounters& counters)
+    {
+        AtomicMax(counters.maxDepth, counters.depth.fetch_add(1, std::memory_order_relaxed) + 1);
+        return Profiler::GetTicks();
+    }
+
+    static uint64_t OnStarted(QueueCounters& counters, uint64_t enqueueTicks)
+    {
+        const uint64_t start = Profiler::GetTicks();
+        const uint64_t latency = start - enqueueTicks;
+
+        counters.depth.fetch_sub(1, std::memory_order_relaxed);
+        counters.count.fetch_add(1, std::memory_order_relaxed);
+        counters.latencySum.fetch_add(latency, std::memory_order_relaxed);
+        AtomicMax(counters.latencyMax, latency);
+
+        return start;
+    }
+
+    static void OnFinished(QueueCounters& counters, uint64_t start)
+    {
+        const uint64_t run = Profiler::GetTicks() - start;
+
+        counters.runSum.fetch_add(run, std::memory_order_relaxed);
+        AtomicMax(counters.runMax, run);
+    }
+
+    static QueueStats CollectStats(QueueCounters& counters)
+    {
+        QueueStats stats;
+        stats.count = counters.count.exchange(0, std::memory_order_relaxed);
+        stats.depth = counters.depth.load(std::memory_order_relaxed);
+        stats.maxDepth = std::max(counters.maxDepth.exchange(stats.depth, std::memory_order_relaxed), stats.depth);
+        stats.latencyMax = float(Profiler::TicksToMilliseconds(counters.latencyMax.exchange(0, std::memory_order_relaxed)));
+        stats.runMax = float(Profiler::TicksToMilliseconds(counters.runMax.exchange(0, std::memory_order_relaxed)));
+
+        const uint64_t latencySum = counters.latencySum.exchange(0, std::memory_order_relaxed);
+        const uint64_t runSum = counters.runSum.exchange(0, std::memory_order_relaxed);
+        if (stats.count)
+        {
+            stats.latencyMean = float(Profiler::TicksToMilliseconds(latencySum) / stats.count);
+            stats.runMean = float(Profiler::TicksToMilliseconds(runSum) / stats.count);
+        }
+
+        return stats;
+    }
+
+    static void UpdateStats(Application::ApplicationContext& ctx)
+    {
+        ctx.appStats.workerTasks = CollectStats(ctx.workerTaskCounters);
+        ctx.appStats.mainThreadJobs = CollectStats(ctx.mainThreadJobCounters);
+        ctx.appStats.missedDeadlines = ctx.missedDeadlines.exchange(0, std::memory_order_relaxed);
+    }
+
+    std::future<void> SubmitTask(const std::function<void()>& function)
+    {
+        auto& c = Application::GetAppContext();
+        const uint64_t enqueueTicks = OnSubmitted(c.workerTaskCounters);
+
+        return c.executor.async([function, enqueueTicks, &counters = c.workerTaskCounters]() {
+            const uint64_t start = OnStarted(counters, enqueueTicks);
+            function();
+            OnFinished(counters, start);
+        });
+    }
 
     Future RunTaskflow(Taskflow& taskflow) { return Application::GetAppContext().executor.run(taskflow); }
 
     void WaitForAll() { Application::GetAppContext().executor.wait_for_all(); }
 
-    void SetMainThreadMaxJobsPerFrame(uint32_t max) { Application::GetAppContext().mainThreadMaxJobsPerFrame = max; }
+    void SetMainThreadJobBudget(uint32_t microseconds) { Application::GetAppContext().mainThreadJobBudget = microseconds; }
+
+    // heap order, true when 'a' runs after 'b'
+    static bool RunsAfter(const QueuedJob* a, const QueuedJob* b)
+    {
+        if (a->deadlineFrame != b->deadlineFrame)
+            return a->deadlineFrame > b->deadlineFrame;
+
+        return a->sequence > b->sequence;
+    }
+
+    static QueuedJob* PopJob(Lane& lane)
+    {
+        if (!lane.pending.load(std::memory_order_acquire))
+            return nullptr;
+
+        std::scoped_lock<std::mutex> lock(lane.mutex);
+        if (lane.heap.empty())
+            return nullptr;
+
+        std::pop_heap(lane.heap.begin(), lane.heap.end(), RunsAfter);
+        QueuedJob* job = lane.heap.back();
+        lane.heap.pop_back();
+        lane.pending.fetch_sub(1, std::memory_order_release);
+
+        return job;
+    }
+
+    static void RunJob(Application::ApplicationContext& ctx, QueuedJob* job)
+    {
+        const uint64_t start = OnStarted(ctx.workerTaskCounters, job->enqueueTicks);
+        job->function();
+        OnFinished(ctx.workerTaskCounters, start);
+
+        if (job->deadlineFrame != c_NoDeadline && ctx.frameIndex.load(std::memory_order_relaxed) > job->deadlineFrame)
+            ctx.missedDeadlines.fetch_add(1, std::memory_order_relaxed);
+
+        ctx.workerJobPool.Free(job);
+    }
+
+    // one executor task per submitted job, it runs whichever job is the most urgent when it starts
+    static void RunNextJob(Application::ApplicationContext& ctx)
+    {
+        for (auto& lane : ctx.jobLanes)
+        {
+            if (QueuedJob* job = PopJob(lane))
+            {
+                RunJob(ctx, job);
+                return;
+            }
+        }
+    }
+
+    void Submit(Job&& job, Priority priority, uint64_t deadlineFrame)
+    {
+        auto& c = Application::GetAppContext();
+        QueuedJob* queued = c.workerJobPool.Allocate(std::move(job), OnSubmitted(c.workerTaskCounters), deadlineFrame, c.jobSequence.fetch_add(1, std::memory_order_relaxed));
+
+        Lane& lane = c.jobLanes[size_t(priority)];
+        {
+            std::scoped_lock<std::mutex> lock(lane.mutex);
+            lane.heap.push_back(queued);
+            std::push_heap(lane.heap.begin(), lane.heap.end(), RunsAfter);
+            lane.pending.fetch_add(1, std::memory_order_release);
+        }
+
+        // a single pointer, small enough for the inline storage of the executor's std::function
+        c.executor.silent_async([&c]() { RunNextJob(c); });
+    }
+
+    void Submit(Job&& job) { Submit(std::move(job), Priority::Normal); }
+
+    bool ShouldYield()
+    {
+        auto& c = Application::GetAppContext();
+        return c.jobLanes[size_t(Priority::FrameCritical)].pending.load(std::memory_order_relaxed) != 0;
+    }
+
+    bool YieldIfNeeded()
+    {
+        auto& c = Application::GetAppContext();
+
+        // the executor tasks queued for these jobs find their lane empty later and return
+        bool ran = false;
+        while (QueuedJob* job = PopJob(c.jobLanes[size_t(Priority::FrameCritical)]))
+        {
+            RunJob(c, job);
+            ran = true;
+        }
+
+        return ran;
+    }
+
+    Executor& GetExecutor() { return Application::GetAppContext().executor; }
+
+    struct CPUInfo
+    {
+        uint32_t index = 0;
+        uint32_t node = 0;
+        uint64_t core = 0; // package << 32 | core, shared by SMT siblings
+    };
+
+    struct ThreadPlacement
+    {
+        std::vector<uint32_t> cpus;
+        int32_t node = c_AnyNode;
+    };
+
+    static thread_local int32_t t_PinnedNode = c_AnyNode;
+
+#if defined(CORE_PLATFORM_LINUX)
+    static uint64_t ReadSysNumber(const std::filesystem::path& path, uint64_t fallback)
+    {
+        std::ifstream file(path);
+        uint64_t value = fallback;
+        return file >> value ? value : fallback;
+    }
+#endif
+
+    // sorted by node then index, online CPUs of processor group 0 on Windows
+    static std::vector<CPUInfo> QueryCPUs()
+    {
+        std::vector<CPUInfo> cpus;
+
+#if defined(CORE_PLATFORM_LINUX)
+        namespace fs = std::filesystem;
+
+        for (uint32_t i = 0;; i++)
+        {
+            const fs::path dir = std::format("/sys/devices/system/cpu/cpu{}", i);
+            if (!fs::exists(dir))
+                break;
+
+            // cpu0 has no 'online' file
+            if (!ReadSysNumber(dir / "online", 1))
+                continue;
+
+            CPUInfo cpu;
+            cpu.index = i;
+            cpu.core = ReadSysNumber(dir / "topology/physical_package_id", 0) << 32 | ReadSysNumber(dir / "topology/core_id", i);
+
+            std::error_code ec;
+            for (const auto& entry : fs::directory_iterator(dir, ec))
+            {
+                const std::string name = entry.path().filename().string();
+                if (name.size() > 4 && name.starts_with("node") && std::isdigit((unsigned char)name[4]))
+                    cpu.node = (uint32_t)std::stoul(name.substr(4));
+            }
+
+            cpus.push_back(cpu);
+        }
+#elif defined(CORE_PLATFORM_WINDOWS)
+        DWORD length = 0;
+        GetLogicalProcessorInformationEx(RelationAll, nullptr, &length);
+
+        std::vector<uint8_t> buffer(length);
+        if (GetLogicalProcessorInformationEx(RelationAll, (PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX)buffer.data(), &length))
+        {
+            std::array<uint32_t, 64> nodes = {};
+            std::array<uint64_t, 64> cores = {};
+            uint64_t present = 0;
+            uint64_t coreIndex = 0;
+
+            for (DWORD offset = 0; offset < length;)
+            {
+                auto info = (PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX)(buffer.data() + offset);
+
+                if (info->Relationship == RelationProcessorCore && info->Processor.GroupMask[0].Group == 0)
+                {
+                    const uint64_t mask = info->Processor.GroupMask[0].Mask;
+                    for (uint32_t i = 0; i < 64; i++)
+                        if (mask & (1ull << i)) cores[i] = coreIndex;
+
+                    present |= mask;
+                    coreIndex++;
+                }
+                else if (info->Relationship == RelationNumaNode && info->NumaNode.GroupMask.Group == 0)
+                {
+                    const uint64_t mask = info->NumaNode.GroupMask.Mask;
+                    for (uint32_t i = 0; i < 64; i++)
+                        if (mask & (1ull << i)) nodes[i] = info->NumaNode.NodeNumber;
+                }
+
+                offset += info->Size;
+            }
+
+            for (uint32_t i = 0; i < 64; i++)
+                if (present & (1ull << i)) cpus.push_back({ i, nodes[i], cores[i] });
+        }
+#endif
+
+        if (cpus.empty())
+        {
+            for (uint32_t i = 0; i < std::max(std::thread::hardware_concurrency(), 1u); i++)
+                cpus.push_back({ i, 0, i });
+        }
+
+        std::stable_sort(cpus.begin(), cpus.end(), [](const CPUInfo& a, const CPUInfo& b) { return a.node < b.node; });
+
+        return cpus;
+    }
+
+    static const std::vector<CPUInfo>& GetCPUs()
+    {
+        static const std::vector<CPUInfo> s_CPUs = QueryCPUs();
+        return s_CPUs;
+    }
+
+    // [0] is the main thread when it is pinned, the workers follow
+    static std::vector<ThreadPlacement> PlaceThreads(const ExecutorDesc& desc, uint32_t workerCount)
+    {
+        std::vector<CPUInfo> candidates;
+        std::unordered_set<uint64_t> cores;
+        for (const CPUInfo& cpu : GetCPUs())
+        {
+            if (!desc.skipSMTSiblings || cores.insert(cpu.core).second)
+                candidates.push_back(cpu);
+        }
+
+        const uint32_t threadCount = workerCount + (desc.pinMainThread ? 1 : 0);
+        std::vector<ThreadPlacement> placements(threadCount);
+
+        for (uint32_t i = 0; i < threadCount; i++)
+        {
+            const CPUInfo& cpu = candidates[i % candidates.size()];
+            placements[i].node = int32_t(cpu.node);
+
+            if (desc.pinning == Pinning::Core)
+            {
+                placements[i].cpus.push_back(cpu.index);
+            }
+            else
+            {
+                for (const CPUInfo& other : candidates)
+                    if (other.node == cpu.node) placements[i].cpus.push_back(other.index);
+            }
+        }
+
+        return placements;
+    }
+
+    static void PinCurrentThread(const ThreadPlacement& placement)
+    {
+#if defined(CORE_PLATFORM_LINUX)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (uint32_t cpu : placement.cpus)
+            CPU_SET(cpu, &set);
+
+        if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+        {
+            LOG_CORE_WARN("Jops : unable to pin a thread on node {}", placement.node);
+            return;
+        }
+#elif defined(CORE_PLATFORM_WINDOWS)
+        DWORD_PTR mask = 0;
+        for (uint32_t cpu : placement.cpus)
+            mask |= DWORD_PTR(1) << cpu;
+
+        if (!SetThreadAffinityMask(GetCurrentThread(), mask))
+        {
+            LOG_CORE_WARN("Jops : unable to pin a thread on node {}", placement.node);
+            return;
+        }
+#endif
+        t_PinnedNode = placement.node;
+    }
+
+    // pins each worker when it starts
+    class PinningWorkerInterface : public tf::WorkerInterface
+    {
+    public:
+        PinningWorkerInterface(std::vector<ThreadPlacement>&& placements) : m_Placements(std::move(placements)) {}
+
+        void scheduler_prologue(tf::Worker& worker) override { PinCurrentThread(m_Placements[worker.id() % m_Placements.size()]); }
+        void scheduler_epilogue(tf::Worker& worker, std::exception_ptr ptr) override {}
+
+    private:
+        std::vector<ThreadPlacement> m_Placements;
+    };
+
+    static std::shared_ptr<tf::WorkerInterface> CreateWorkerInterface(const ExecutorDesc& desc, uint32_t workerCount)
+    {
+        if (desc.pinning == Pinning::None || workerCount == 0)
+            return nullptr;
+
+        auto placements = PlaceThreads(desc, workerCount);
+        if (desc.pinMainThread)
+            placements.erase(placements.begin());
+
+        return std::make_shared<PinningWorkerInterface>(std::move(placements));
+    }
+
+    static void PinMainThread(const ExecutorDesc& desc, uint32_t workerCount)
+    {
+        if (desc.pinning != Pinning::None && desc.pinMainThread)
+            PinCurrentThread(PlaceThreads(desc, workerCount).front());
+    }
+
+    uint32_t GetNodeCount()
+    {
+        std::unordered_set<uint32_t> nodes;
+        for (const CPUInfo& cpu : GetCPUs())
+            nodes.insert(cpu.node);
+
+        return uint32_t(nodes.size());
+    }
+
+    int32_t GetCurrentNode()
+    {
+        if (t_PinnedNode != c_AnyNode)
+            return t_PinnedNode;
+
+#if defined(CORE_PLATFORM_LINUX)
+        unsigned int cpu = 0;
+        unsigned int node = 0;
+        if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0)
+            return int32_t(node);
+#elif defined(CORE_PLATFORM_WINDOWS)
+        PROCESSOR_NUMBER processor;
+        GetCurrentProcessorNumberEx(&processor);
+
+        USHORT node = 0;
+        if (GetNumaProcessorNodeEx(&processor, &node))
+            return int32_t(node);
+#endif
+        return 0;
+    }
+
+    static void RunChunks(ParallelState& state)
+    {
+        while (true)
+        {
+            const size_t index = state.next.fetch_add(1, std::memory_order_relaxed);
+            if (index >= state.chunkCount)
+                break;
+
+            const size_t begin = state.begin + index * state.grain;
+            state.chunk(state.context, begin, std::min(begin + state.grain, state.end));
+
+            // the finisher of the last chunk wakes the caller, it still holds a reference so the state is alive
+            if (state.done.fetch_add(1, std::memory_order_release) + 1 == state.chunkCount)
+                state.done.notify_all();
+        }
+    }
+
+    static void ReleaseParallelState(Application::ApplicationContext& ctx, ParallelState* state)
+    {
+        if (state->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            ctx.parallelStatePool.Free(state);
+    }
+
+    void ParallelRun(size_t begin, size_t end, size_t grain, ChunkFunction chunk, void* context, int32_t node)
+    {
+        if (begin >= end)
+            return;
+
+        grain = std::max<size_t>(grain, 1);
+        const size_t chunkCount = (end - begin + grain - 1) / grain;
+        if (chunkCount == 1)
+        {
+            chunk(context, begin, end);
+            return;
+        }
+
+        auto& c = Application::GetAppContext();
+        // the caller takes chunks too, one helper per remaining chunk at most. With a node, helpers picked up by a
+        // worker of another node leave and the caller runs what they would have claimed
+        const size_t helpers = std::min<size_t>(c.executor.num_workers(), chunkCount - 1);
+
+        // helpers starting late find nothing to claim, they only touch the state, which outlives the call
+        ParallelState* state = c.parallelStatePool.Allocate();
+        state->begin = begin;
+        state->end = end;
+        state->grain = grain;
+        state->chunkCount = chunkCount;
+        state->chunk = chunk;
+        state->context = context;
+        state->node = node;
+        state->references.store(uint32_t(helpers + 1), std::memory_order_relaxed);
+
+        for (size_t i = 0; i < helpers; i++)
+        {
+            c.executor.silent_async([state, &c]() {
+                if (state->node == c_AnyNode || GetCurrentNode() == state->node)
+                    RunChunks(*state);
+
+                ReleaseParallelState(c, state);
+            });
+        }
+
+        RunChunks(*state);
+
+        // every chunk is claimed, sleep until the ones still running on workers are done
+        for (size_t done = state->done.load(std::memory_order_acquire); done < chunkCount; done = state->done.load(std::memory_order_acquire))
+            state->done.wait(done, std::memory_order_acquire);
+
+        ReleaseParallelState(c, state);
+    }
+
+    void SubmitToMainThread(Job&& job)
+    {
+        auto& c = Application::GetAppContext();
+        const uint64_t enqueueTicks = OnSubmitted(c.mainThreadJobCounters);
+
+        c.mainThreadQueue.Push({ std::move(job), enqueueTicks });
+    }
 
     void SubmitToMainThread(const std::function<void()>& function)
+    {
+        // one allocation, std::function is not nothrow movable everywhere and a Job needs its callable to be
+        SubmitToMainThread(Job([function = std::make_unique<std::function<void()>>(function)]() { (*function)(); }));
+    }
+
+    bool IsMainThread() { return std::this_thread::get_id() == Application::GetAppContext().mainThreadId; }
+
+    static uint64_t HashCombine(uint64_t hash, uint64_t value)
+    {
+        hash ^= value;
+        hash *= 1099511628211ull;
+        return hash;
+    }
+
+    void FrameGraph::AddTask(std::string_view name, std::initializer_list<std::string_view> reads, std::initializer_list<std::string_view> writes, FrameTaskFunction&& function)
+    {
+        FrameTask& task = m_Tasks.emplace_back();
+        task.name = name;
+        task.firstResource = uint32_t(m_Resources.size());
+        task.readCount = uint32_t(reads.size());
+        task.writeCount = uint32_t(writes.size());
+        task.function = std::move(function);
+
+        m_Hash = HashCombine(m_Hash, Profiler::MakeScopeID(name));
+        m_Hash = HashCombine(m_Hash, uint64_t(task.readCount) << 32 | task.writeCount);
+
+        for (auto resources : { reads, writes })
+        {
+            for (std::string_view resource : resources)
+            {
+                const uint64_t id = Profiler::MakeScopeID(resource);
+                m_Resources.push_back(id);
+                m_Hash = HashCombine(m_Hash, id);
+            }
+        }
+    }
+
+    void FrameGraph::Rebuild()
+    {
+        struct ResourceState
+        {
+            int32_t writer = -1;
+            std::vector<uint32_t> readers; // since the last write
+        };
+
+        std::unordered_map<uint64_t, ResourceState> resources;
+        std::vector<GraphTask> tasks(m_Tasks.size());
+
+        m_Taskflow.clear();
+
+        // declaration order, which is the LayerStack order, decides who goes first on a shared resource
+        for (uint32_t i = 0; i < m_Tasks.size(); i++)
+        {
+            const FrameTask& task = m_Tasks[i];
+
+            // by index, the functions are declared again every frame while the taskflow is reused
+            tasks[i] = m_Taskflow.emplace([this, i](tf::Subflow& subflow) {
+                FrameTask& frameTask = m_Tasks[i];
+                BUILTIN_PROFILE_CPU(frameTask.name);
+                frameTask.function(subflow, *m_Info);
+            }).name(std::string(task.name));
+
+            for (uint32_t r = 0; r < task.readCount; r++)
+            {
+                ResourceState& state = resources[m_Resources[task.firstResource + r]];
+                if (state.writer >= 0)
+                    tasks[state.writer].precede(tasks[i]);
+
+                state.readers.push_back(i);
+            }
+
+            for (uint32_t w = 0; w < task.writeCount; w++)
+            {
+                ResourceState& state = resources[m_Resources[task.firstResource + task.readCount + w]];
+                if (state.writer >= 0 && uint32_t(state.writer) != i)
+                    tasks[state.writer].precede(tasks[i]);
+
+                for (uint32_t reader : state.readers)
+                {
+                    if (reader != i)
+                        tasks[reader].precede(tasks[i]);
+                }
+
+                state.readers.clear();
+                state.writer = int32_t(i);
+            }
+        }
+
+        m_BuiltHash = m_Hash;
+        m_RebuildCount++;
+    }
+
+    void FrameGraph::Run(const Core::FrameInfo& info)
+    {
+        if (m_Tasks.empty())
+            return;
+
+        if (m_Hash != m_BuiltHash || m_Taskflow.empty())
+            Rebuild();
+
+        m_Info = &info;
+        RunTaskflow(m_Taskflow).wait();
+        m_Info = nullptr;
+
+        // the vectors keep their capacity, declaring the same tasks next frame allocates nothing
+        m_Tasks.clear();
+        m_Resources.clear();
+        m_Hash = c_EmptyHash;
+    }
+
+    template<size_t Size>
+    struct CoroutineFrame
+    {
+        CoroutineFrame() {} // left uninitialized
+        alignas(std::max_align_t) std::byte data[Size];
+    };
+
+    // outlive the application, a frame may be freed by a worker while the executor drains
+    static TaskPool<CoroutineFrame<128>> s_CoroutineFrames128;
+    static TaskPool<CoroutineFrame<256>> s_CoroutineFrames256;
+    static TaskPool<CoroutineFrame<512>> s_CoroutineFrames512;
+    static TaskPool<CoroutineFrame<1024>> s_CoroutineFrames1024;
+    static TaskPool<CoroutineFrame<2048>> s_CoroutineFrames2048;
+
+    void* AllocateCoroutineFrame(size_t size)
+    {
+        if (size <= 128)  return s_CoroutineFrames128.Allocate();
+        if (size <= 256)  return s_CoroutineFrames256.Allocate();
+        if (size <= 512)  return s_CoroutineFrames512.Allocate();
+        if (size <= 1024) return s_CoroutineFrames1024.Allocate();
+        if (size <= 2048) return s_CoroutineFrames2048.Allocate();
+
+        return ::operator new(size);
+    }
+
+    void FreeCoroutineFrame(void* frame, size_t size)
+    {
+        if (size <= 128)       s_CoroutineFrames128.Free(static_cast<CoroutineFrame<128>*>(frame));
+        else if (size <= 256)  s_CoroutineFrames256.Free(static_cast<CoroutineFrame<256>*>(frame));
+        else if (size <= 512)  s_CoroutineFrames512.Free(static_cast<CoroutineFrame<512>*>(frame));
+        else if (size <= 1024) s_CoroutineFrames1024.Free(static_cast<CoroutineFrame<1024>*>(frame));
+        else if (size <= 2048) s_CoroutineFrames2048.Free(static_cast<CoroutineFrame<2048>*>(frame));
+        else ::operator delete(frame);
+    }
+
+    void ResumeNextFrame(std::coroutine_handle<> handle, std::coroutine_handle<> owner)
     {
         auto& c = Application::GetAppContext();
-        std::scoped_lock<std::mutex> lock(c.mainThreadQueueMutex);
-        c.mainThreadQueue.push(function);
+
+        std::scoped_lock<std::mutex> lock(c.nextFrameCoroutinesMutex);
+        c.nextFrameCoroutines.emplace_back(handle, owner);
+    }
+
+    static void ResumeNextFrameCoroutines(Application::ApplicationContext& ctx)
+    {
+        {
+            std::scoped_lock<std::mutex> lock(ctx.nextFrameCoroutinesMutex);
+            std::swap(ctx.nextFrameCoroutines, ctx.resumingCoroutines);
+        }
+
+        // a coroutine awaiting NextFrame() again lands in the other list, for the frame after
+        for (auto& coroutine : ctx.resumingCoroutines)
+            coroutine.Resume();
+
+        ctx.resumingCoroutines.clear();
     }
 }
 
@@ -3061,18 +4432,149 @@ namespace Application {
     void Restart() { GetAppContext().running = false; }
     void Shutdown() { GetAppContext().running = false;  GetAppContext().s_ApplicationRunning = false; }
     bool IsApplicationRunning() { return GetAppContext().s_ApplicationRunning; }
+    static bool IsWindowless(const ApplicationContext& ctx)
+    {
+        return ctx.applicatoinDesc.headless || ctx.applicatoinDesc.deviceDesc.headlessDevice;
+    }
+
+    // headless with a fixed timestep, the clock is ignored
+    static bool IsDeterministic(const ApplicationContext& ctx)
+    {
+        return IsWindowless(ctx) && ctx.applicatoinDesc.fixedTimestep > 0.0f;
+    }
+
+    // sleeps until the next tick of headlessUpdateRate, a late frame moves the ticks instead of running a burst after it
+    static void PaceHeadlessFrame(ApplicationContext& ctx)
+    {
+        using namespace std::chrono;
+
+        const auto period = duration_cast<steady_clock::duration>(duration<double>(1.0 / ctx.applicatoinDesc.headlessUpdateRate));
+        ctx.nextHeadlessFrame = std::max(ctx.nextHeadlessFrame + period, steady_clock::now());
+
+        std::this_thread::sleep_until(ctx.nextHeadlessFrame);
+    }
+
+    // Fixed steps covering the time since the last frame, alpha is the fraction of a step left in the accumulator.
+    // Headless, every frame is exactly one step regardless of the clock, so a replay gives the same results.
+    static void RunFixedSteps(ApplicationContext& ctx, FrameInfo& info)
+    {
+        const double dt = ctx.applicatoinDesc.fixedTimestep;
+        ctx.appStats.fixedSteps = 0;
+        ctx.appStats.droppedFixedSteps = 0;
+
+        if (dt <= 0.0)
+            return;
+
+        if (IsDeterministic(ctx))
+            ctx.fixedAccumulator = dt;
+        else
+            ctx.fixedAccumulator += info.ts.Seconds();
+
+        uint32_t steps = 0;
+        while (ctx.fixedAccumulator >= dt && steps < ctx.applicatoinDesc.maxFixedSteps)
+        {
+            for (Layer* layer : ctx.layerStack)
+                layer->OnFixedUpdate(Timestep(float(dt)));
+
+            ctx.fixedAccumulator -= dt;
+            steps++;
+        }
+
+        // no spiral of death, the simulation slows down instead, the phase within a step is kept
+        if (ctx.fixedAccumulator >= dt)
+        {
+            ctx.appStats.droppedFixedSteps = uint32_t(ctx.fixedAccumulator / dt);
+            ctx.fixedAccumulator = std::fmod(ctx.fixedAccumulator, dt);
+        }
+
+        ctx.appStats.fixedSteps = steps;
+        info.alpha = float(ctx.fixedAccumulator / dt);
+    }
+
+    static void WaitForParallelUpdate(ApplicationContext& ctx)
+    {
+        while (ctx.parallelUpdateRunning.load(std::memory_order_acquire))
+        {
+            // the update is frame-critical, the main thread runs it itself when no worker has started it yet
+            if (!Jops::YieldIfNeeded())
+                ctx.parallelUpdateRunning.wait(true, std::memory_order_acquire);
+        }
+    }
+
+    static void UpdateLayersInParallel(ApplicationContext& ctx, const FrameInfo& info)
+    {
+        if (!ctx.applicatoinDesc.pipelinedUpdate)
+        {
+            for (Layer* layer : ctx.layerStack)
+                layer->OnParallelUpdate(info);
+
+            for (Layer* layer : ctx.layerStack)
+                layer->OnSwapState();
+
+            return;
+        }
+
+        {
+            BUILTIN_PROFILE_CPU("Wait Parallel Update");
+            WaitForParallelUpdate(ctx);
+        }
+
+        for (Layer* layer : ctx.parallelLayers)
+            layer->OnSwapState();
+
+        // the worker goes through a copy, layers pushed meanwhile join on the next frame
+        ctx.parallelLayers.assign(ctx.layerStack.begin(), ctx.layerStack.end());
+        ctx.parallelUpdateInfo = { info.ts, nullptr, info.alpha };
+        ctx.parallelUpdateRunning.store(true, std::memory_order_relaxed);
+
+        Jops::Submit([&ctx]() {
+            BUILTIN_PROFILE_CPU("layerStack OnParallelUpdate");
+
+            for (Layer* layer : ctx.parallelLayers)
+                layer->OnParallelUpdate(ctx.parallelUpdateInfo);
+
+            ctx.parallelUpdateRunning.store(false, std::memory_order_release);
+            ctx.parallelUpdateRunning.notify_one();
+        }, Jops::Priority::FrameCritical);
+    }
+
+    // a layer must not be detached while the worker still goes through it
+    static void RemoveFromParallelUpdate(ApplicationContext& ctx, Layer* layer)
+    {
+        WaitForParallelUpdate(ctx);
+        std::erase(ctx.parallelLayers, layer);
+    }
+
     void PushLayer(Layer* overlay) { GetAppContext().layerStack.PushLayer(overlay); }
     void PushOverlay(Layer* layer) { GetAppContext().layerStack.PushOverlay(layer); }
-    void PopLayer(Layer* layer) { GetAppContext().layerStack.PopLayer(layer); }
-    void PopOverlay(Layer* overlay) { GetAppContext().layerStack.PopOverlay(overlay); }
+
+    void PopLayer(Layer* layer)
+    {
+        RemoveFromParallelUpdate(GetAppContext(), layer);
+        GetAppContext().layerStack.PopLayer(layer);
+    }
+
+    void PopOverlay(Layer* overlay)
+    {
+        RemoveFromParallelUpdate(GetAppContext(), overlay);
+        GetAppContext().layerStack.PopOverlay(overlay);
+    }
     const Stats& GetStats() { return GetAppContext().appStats; }
+    uint64_t GetFrameIndex() { return GetAppContext().frameIndex.load(std::memory_order_relaxed); }
     const ApplicationDesc& GetApplicationDesc() { return GetAppContext().applicatoinDesc; }
     float GetAverageFrameTimeSeconds() { return GetAppContext().averageFrameTime; }
     float GetLastFrameTime() { return  GetAppContext().lastFrameTime; }
     float GetTimestamp() { return GetAppContext().frameTimestamp; }
     void  SetFrameTimeUpdateInterval(float seconds) { GetAppContext().averageTimeUpdateInterval = seconds; }
     Window& GetWindow() { return  GetAppContext().mainWindow; }
-    float GetTime() { return static_cast<float>(glfwGetTime()); }
+    float GetTime()
+    {
+        auto& c = GetAppContext();
+        if (c.applicatoinDesc.headless)
+            return std::chrono::duration<float>(std::chrono::steady_clock::now() - c.startTime).count();
+
+        return static_cast<float>(glfwGetTime());
+    }
 
     void ApplicationContext::Run()
     {
@@ -3088,28 +4590,47 @@ namespace Application {
             float time = Application::GetTime();
             Timestep timestep = time - lastFrameTime;
             lastFrameTime = time;
+
+            if (IsDeterministic(*this))
+                timestep = applicatoinDesc.fixedTimestep;
+
             frameTimestamp = timestep;
 
             blockingEventsUntilNextFrame = false;
 
+            {
+                BUILTIN_PROFILE_CPU("Next Frame Coroutines");
+                Jops::ResumeNextFrameCoroutines(*this);
+            }
+
             {
                 CORE_PROFILE_SCOPE_NC("ExecuteMainThreadQueue", 0xAA0000);
+                BUILTIN_PROFILE_CPU("Main Thread Jobs");
 
-                std::scoped_lock<std::mutex> lock(mainThreadQueueMutex);
-                size_t count = std::min(mainThreadMaxJobsPerFrame, (uint32_t)mainThreadQueue.size());
-                for (size_t i = 0; i < count; i++)
+                // no lock is held while a job runs, producers never wait on the main thread
+                const uint64_t begin = Profiler::GetTicks();
+                const double budget = mainThreadJobBudget * 0.001; // ms
+
+                Jops::QueuedJob job;
+                while (mainThreadQueue.TryPop(job))
                 {
-                    mainThreadQueue.front()();
-                    mainThreadQueue.pop();
+                    const uint64_t start = Jops::OnStarted(mainThreadJobCounters, job.enqueueTicks);
+                    job.function();
+                    Jops::OnFinished(mainThreadJobCounters, start);
+
+                    job.function.Reset();
+
+                    if (Profiler::TicksToMilliseconds(Profiler::GetTicks() - begin) >= budget)
+                        break;
                 }
             }
 
-            bool headlessDevice = applicatoinDesc.deviceDesc.headlessDevice;
+            const bool windowless = IsWindowless(*this);
 
-            if (!mainWindow.IsMinimized())
+            if (windowless || !mainWindow.IsMinimized())
             {
                 nvrhi::IFramebuffer* framebuffer = nullptr;
-                if (!headlessDevice)
+                if (!windowless)
                 {
                     auto sc = GetAppContext().mainWindow.swapChain;
 
@@ -3133,6 +4654,30 @@ namespace Application {
                         layer->OnBegin(info);
                 }
 
+                {
+                    CORE_PROFILE_SCOPE("LayerStack OnFixedUpdate");
+                    BUILTIN_PROFILE_CPU("layerStack OnFixedUpdate");
+
+                    RunFixedSteps(*this, info);
+                }
+
+                {
+                    CORE_PROFILE_SCOPE("LayerStack OnParallelUpdate");
+                    BUILTIN_PROFILE_CPU("layerStack Parallel Stage");
+
+                    UpdateLayersInParallel(*this, info);
+                }
+
+                {
+                    CORE_PROFILE_SCOPE("LayerStack Frame Tasks");
+                    BUILTIN_PROFILE_CPU("layerStack Frame Tasks");
+
+                    for (Layer* layer : layerStack)
+                        layer->OnDeclareTasks(frameGraph);
+
+                    frameGraph.Run(info);
+                }
+
                 {
                     CORE_PROFILE_SCOPE("LayerStack OnUpdate");
                     BUILTIN_PROFILE_CPU("layerStack OnUpdate");
@@ -3149,7 +4694,7 @@ namespace Application {
                         layer->OnEnd(info);
                 }
 
-                if (!headlessDevice)
+                if (!windowless)
                 {
                     BUILTIN_PROFILE_CPU("Present");
 
@@ -3165,18 +4710,34 @@ namespace Application {
                 std::this_thread::sleep_for(std::chrono::milliseconds(10));
             }
 
-            if (!headlessDevice)
+            if (!windowless)
                 mainWindow.UpdateEvent();
 
             Profiler::EndFrame();
+            Jops::UpdateStats(*this);
+            frameIndex.fetch_add(1, std::memory_order_relaxed);
+
+            if (applicatoinDesc.headless && applicatoinDesc.headlessUpdateRate > 0.0f)
+            {
+                BUILTIN_PROFILE_CPU("Wait Headless Frame");
+                PaceHeadlessFrame(*this);
+            }
 
             CORE_PROFILE_FRAME();
         }
+
+        WaitForParallelUpdate(*this);
+
+        if (Profiler::IsCapturing() && !applicatoinDesc.profilerCaptureFile.empty())
+        {
+            Profiler::EndCapture();
+            Profiler::WriteCapture(applicatoinDesc.profilerCaptureFile);
+        }
     }
 
     ApplicationContext::ApplicationContext(const ApplicationDesc& desc)
         : applicatoinDesc(desc)
-        , executor(desc.workersNumber)
+        , executor(desc.workersNumber, Jops::CreateWorkerInterface(desc.executorDesc, desc.workersNumber))
     {
         CORE_PROFILE_FUNCTION();
 
@@ -3187,9 +4748,17 @@ namespace Application {
         LOG_CORE_INFO("Creat Application [{}]", applicatoinDesc.windowDesc.title);
 
         s_Instance = this;
+        mainThreadId = std::this_thread::get_id();
+        Jops::PinMainThread(desc.executorDesc, desc.workersNumber);
+
+        // the thread creating the application is the main thread, it gets the first profiler buffer
+        cpuProfilerGeneration = ++Profiler::s_CPUProfilerGeneration;
+        Profiler::GetCPUThreadBuffer();
 
-        cpuProfilerRecords.resize(100);
-        gpuProfilerRecords.resize(100);
+        if (!applicatoinDesc.profilerCaptureFile.empty())
+            Profiler::BeginCapture();
+
+        gpuProfilerRecords.resize(256);
 
         auto commandLineArgs = applicatoinDesc.commandLineArgs;
         if (commandLineArgs.count > 1)
@@ -3204,7 +4773,10 @@ namespace Application {
         if (!applicatoinDesc.workingDirectory.empty())
             std::filesystem::current_path(applicatoinDesc.workingDirectory);
 
-        if (!applicatoinDesc.deviceDesc.headlessDevice)
+        if (applicatoinDesc.headless)
+            LOG_CORE_INFO("Headless, no window and no device");
+
+        if (!IsWindowless(*this))
         {
             mainWindow.Init(applicatoinDesc.windowDesc);
             mainWindow.eventCallback = [](Event& e) {
@@ -3229,12 +4801,36 @@ namespace Application {
             };
         }
 
-        if (applicatoinDesc.createDefaultDevice)
+        if (applicatoinDesc.createDefaultDevice && !applicatoinDesc.headless)
             RHI::TryCreateDefaultDevice();
 
-        if (!applicatoinDesc.deviceDesc.headlessDevice)
+        if (!IsWindowless(*this))
         {
             mainWindow.swapChain = RHI::GetDeviceManager()->CreateSwapChain(mainWindow.desc.swapChainDesc, mainWindow.handle);
         }
     }
+
+    ApplicationContext::~ApplicationContext()
+    {
+        // the members are destroyed after this body, nothing may still run on the workers by then
+        executor.wait_for_all();
+
+        if (profilerTaskObserver)
+            executor.remove_observer(std::move(profilerTaskObserver));
+
+        // detached coroutines still waiting for the main thread are destroyed while the whole context is alive, their
+        // locals may still use it. The other main thread jobs are dropped without running.
+        {
+            Jops::QueuedJob job;
+            while (mainThreadQueue.TryPop(job));
+
+            nextFrameCoroutines.clear();
+        }
+
+        // the thread buffers are freed with the context, the allocation hooks must stop using them
+        ++Profiler::s_CPUProfilerGeneration;
+
+        for (auto& buffer : cpuProfilerThreads)
+            Profiler::ClosePerfCounters(*buffer);
+    }
 }
@@ -178,6 +178,15 @@
             Profiler::CPUScope _profiler_cpu_scope_timer(name);\
             Profiler::GPUScope _profiler_gpu_scope_timer(device, commandList, name)
 
+// opt-in, also replaces the global operator new/delete in Core/EntryPoint.h
+#ifdef CORE_TRACK_ALLOCATIONS
+#   define BUILTIN_PROFILE_ALLOC(size) Profiler::TrackAllocation(size)
+#   define BUILTIN_PROFILE_FREE() Profiler::TrackFree()
+#else
+#   define BUILTIN_PROFILE_ALLOC(size)
+#   define BUILTIN_PROFILE_FREE()
+#endif
+
 #if CORE_PROFILE 
 #   ifndef TRACY_ENABLE
 #       define TRACY_ENABLE
@@ -191,8 +200,8 @@
 #   define CORE_PROFILE_TAG(y, x) ZoneText(x, strlen(x))
 #   define CORE_PROFILE_LOG(text, size) TracyMessage(text, size)
 #   define CORE_PROFILE_VALUE(text, value) TracyPlot(text, value)
-#   define CORE_PROFILE_ALLOC(p, size) TracyAlloc(ptr, size)
-#   define CORE_PROFILE_FREE(p) TracyFree(ptr);
+#   define CORE_PROFILE_ALLOC(p, size) TracyAlloc(p, size)
+#   define CORE_PROFILE_FREE(p) TracyFree(p)
 #else
 #   define CORE_PROFILE_SCOPE(name)
 #   define CORE_PROFILE_SCOPE_COLOR(color)
@@ -234,9 +243,11 @@
 #ifdef  META
 #   define TYPE(...)   __attribute__((annotate("TYPE____ "#__VA_ARGS__)))
 #   define PROPERTY(...) __attribute__((annotate("PROPERTY "#__VA_ARGS__)))
+#   define FUNCTION(...) __attribute__((annotate("FUNCTION "#__VA_ARGS__)))
 #else 
 #   define TYPE(...)
 #   define PROPERTY(...)
+#   define FUNCTION(...)
 #endif
 
 #define MetaHeader(nameSpace)                                                                                                            \
@@ -262,4 +273,16 @@ namespace Meta::nameSpace{
     }                                                                                                                                    \
                                                                                                                                          \
     inline const Meta::Type* Type(const std::string_view& name) { return Registry().GetType(name); }                                           \
+                                                                                                                                         \
+    template<typename T>                                                                                                                 \
+    inline const Meta::Enum* Enum()                                                                                                      \
+    {                                                                                                                                    \
+        auto str = std::string_view(typeid(T).name());                                                                                   \
+                                                                                                                                         \
+        if (str.substr(0, 5) == "enum ") str = str.substr(5);                                                                            \
+                                                                                                                                         \
+        return Registry().GetEnum(str);                                                                                                  \
+    }                                                                                                                                    \
+                                                                                                                                         \
+    inline const Meta::Enum* Enum(const std::string_view& name) { return Registry().GetEnum(name); }                                     \
 }
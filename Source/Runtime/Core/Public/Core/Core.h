@@ -21,6 +21,11 @@ namespace Math = glm;
 #include <filesystem>
 #include <string>
 #include <span>
+#include <numeric>
+#include <source_location>
+#include <coroutine>
+#include <optional>
+#include <unordered_set>
 
 using std::uint8_t;
 using std::uint16_t;
@@ -28,6 +33,22 @@ using std::uint32_t;
 using std::uint64_t;
 using std::size_t;
 
+namespace Profiler {
+
+    // allocation hooks, see CORE_TRACK_ALLOCATIONS
+    CORE_API void TrackAllocation(uint64_t size);
+    CORE_API void TrackFree();
+
+    // set by the executable that defines CORE_TRACK_ALLOCATIONS, inline code checks it instead of the macro so it expands the same in every translation unit
+    CORE_API void SetTrackingAllocations(bool enable);
+    CORE_API bool IsTrackingAllocations();
+}
+
+namespace Jops {
+
+    class FrameGraph;
+}
+
 namespace Core {
 
     //////////////////////////////////////////////////////////////////////////
@@ -210,10 +231,23 @@ namespace Core {
             Release();
             data = (uint8_t*)std::malloc(pSize);
             size = pSize;
+
+            if (Profiler::IsTrackingAllocations())
+                Profiler::TrackAllocation(pSize);
+
+            CORE_PROFILE_ALLOC(data, pSize);
         }
 
         inline void Release()
         {
+            if (data)
+            {
+                if (Profiler::IsTrackingAllocations())
+                    Profiler::TrackFree();
+
+                CORE_PROFILE_FREE(data);
+            }
+
             free(data);
             data = nullptr;
             size = 0;
@@ -238,6 +272,86 @@ namespace Core {
         Buffer m_Buffer;
     };
 
+    // Move-only callable stored in place, never allocates. A callable larger than 'Capacity' does not compile.
+    template<typename Signature, size_t Capacity = 64>
+    class InlineFunction;
+
+    template<typename R, typename... Args, size_t Capacity>
+    class InlineFunction<R(Args...), Capacity>
+    {
+    public:
+        InlineFunction() = default;
+        InlineFunction(std::nullptr_t) {}
+
+        template<typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, InlineFunction> && std::is_invocable_r_v<R, std::decay_t<F>&, Args...>>>
+        InlineFunction(F&& f)
+        {
+            using Fn = std::decay_t<F>;
+            static_assert(sizeof(Fn) <= Capacity, "callable too large for InlineFunction, capture less or raise the capacity");
+            static_assert(alignof(Fn) <= alignof(std::max_align_t));
+            static_assert(std::is_nothrow_move_constructible_v<Fn>);
+
+            new (m_Storage) Fn(std::forward<F>(f));
+
+            m_Invoke = [](void* storage, Args&&... args) -> R {
+                return (*static_cast<Fn*>(storage))(std::forward<Args>(args)...);
+            };
+
+            // moves 'src' into 'dst' then destroys 'src', only destroys it when 'dst' is null
+            m_Manage = [](void* dst, void* src) {
+                if (dst)
+                    new (dst) Fn(std::move(*static_cast<Fn*>(src)));
+                static_cast<Fn*>(src)->~Fn();
+            };
+        }
+
+        InlineFunction(InlineFunction&& other) noexcept { MoveFrom(other); }
+
+        InlineFunction& operator=(InlineFunction&& other) noexcept
+        {
+            if (this != &other)
+            {
+                Reset();
+                MoveFrom(other);
+            }
+            return *this;
+        }
+
+        InlineFunction(const InlineFunction&) = delete;
+        InlineFunction& operator=(const InlineFunction&) = delete;
+
+        ~InlineFunction() { Reset(); }
+
+        void Reset()
+        {
+            if (m_Manage)
+                m_Manage(nullptr, m_Storage);
+
+            m_Invoke = nullptr;
+            m_Manage = nullptr;
+        }
+
+        R operator()(Args... args) { return m_Invoke(m_Storage, std::forward<Args>(args)...); }
+        explicit operator bool() const { return m_Invoke != nullptr; }
+
+    private:
+        void MoveFrom(InlineFunction& other)
+        {
+            if (!other.m_Manage)
+                return;
+
+            other.m_Manage(m_Storage, other.m_Storage);
+            m_Invoke = other.m_Invoke;
+            m_Manage = other.m_Manage;
+            other.m_Invoke = nullptr;
+            other.m_Manage = nullptr;
+        }
+
+        alignas(std::max_align_t) std::byte m_Storage[Capacity];
+        R(*m_Invoke)(void*, Args&&...) = nullptr;
+        void(*m_Manage)(void*, void*) = nullptr;
+    };
+
     class CORE_API Image
     {
     public:
@@ -964,6 +1078,7 @@ namespace Core {
     {
         Timestep ts;
         nvrhi::IFramebuffer* fb;
+        float alpha = 1.0f; // with a fixed timestep, how far the frame is between the last fixed step and the next one
     };
 
     class Layer
@@ -975,8 +1090,37 @@ namespace Core {
         inline virtual void OnDetach() {}
         inline virtual void OnEvent(Event& event) {}
         inline virtual void OnBegin(const FrameInfo& info) {}
+        // with ApplicationDesc::fixedTimestep, after OnBegin, zero or more times per frame
+        inline virtual void OnFixedUpdate(Timestep dt) {}
         inline virtual void OnUpdate(const FrameInfo& info) {}
         inline virtual void OnEnd(const FrameInfo& info) {}
+
+        // With ApplicationDesc::pipelinedUpdate it runs on a worker, producing frame N+1 while the main thread runs
+        // OnUpdate/OnEnd/Present of frame N. It writes back buffers only, no window, ImGui or device, and gets no
+        // framebuffer. Without it, it runs on the main thread right before OnUpdate.
+        inline virtual void OnParallelUpdate(const FrameInfo& info) {}
+        // main thread, after OnBegin, while no OnParallelUpdate runs, publishes what the last one produced
+        inline virtual void OnSwapState() {}
+        // main thread, every frame before OnUpdate, the declared tasks run right after on the workers
+        inline virtual void OnDeclareTasks(Jops::FrameGraph& graph) {}
+    };
+
+    // State handed from OnParallelUpdate to the main thread. The update reads Front() and writes Back(), the main
+    // thread reads Front() only, Swap() from OnSwapState.
+    template<typename T>
+    class DoubleBuffered
+    {
+    public:
+        DoubleBuffered() = default;
+        DoubleBuffered(const T& value) : m_Buffers{ value, value } {}
+
+        const T& Front() const { return m_Buffers[m_Front]; }
+        T& Back() { return m_Buffers[m_Front ^ 1]; }
+        void Swap() { m_Front ^= 1; }
+
+    private:
+        T m_Buffers[2] = {};
+        uint32_t m_Front = 0;
     };
 
     class LayerStack
@@ -1295,14 +1439,123 @@ namespace Plugins {
 
 namespace Profiler {
 
+    // the last c_Size samples (ms) of one scope, one sample per frame the scope ran in
+    struct FrameHistory
+    {
+        static constexpr uint32_t c_Size = 256;
+
+        std::array<float, c_Size> samples = {};
+        uint32_t head = 0;
+        uint32_t count = 0;
+        float sum = 0.0f;
+        uint32_t hitchCount = 0; // since the record was created, see SetHitchThreshold()
+
+        inline float Mean() const { return count ? sum / count : 0.0f; }
+
+        inline void Push(float sample)
+        {
+            if (count == c_Size)
+                sum -= samples[head];
+            else
+                count++;
+
+            samples[head] = sample;
+            sum += sample;
+            head = (head + 1) % c_Size;
+        }
+    };
+
+    struct FrameStats
+    {
+        float min = 0.0f;
+        float max = 0.0f;
+        float mean = 0.0f;
+        float p50 = 0.0f;
+        float p95 = 0.0f;
+        float p99 = 0.0f;
+        uint32_t sampleCount = 0;
+        uint32_t hitchCount = 0;
+    };
+
+    // identity of a CPU scope, its name and the place it was opened from, folds to a constant for literal names
+    inline constexpr uint64_t MakeScopeID(std::string_view name, std::string_view file = {}, uint32_t line = 0, uint32_t column = 0)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        for (char c : name)
+        {
+            hash ^= (uint8_t)c;
+            hash *= 1099511628211ull;
+        }
+
+        // the same name, line and column in two files are two scopes
+        hash ^= 0xff;
+        hash *= 1099511628211ull;
+        for (char c : file)
+        {
+            hash ^= (uint8_t)c;
+            hash *= 1099511628211ull;
+        }
+
+        hash ^= (uint64_t(line) << 32) | column;
+        hash *= 1099511628211ull;
+
+        return hash;
+    }
+
+    // hardware counters of a scope, zero unless EnablePerfCounters() succeeded
+    struct PerfCounters
+    {
+        uint64_t cycles = 0;
+        uint64_t instructions = 0;
+        uint64_t cacheMisses = 0; // last level cache
+        uint64_t branchMisses = 0;
+
+        inline float IPC() const { return cycles ? float(instructions) / float(cycles) : 0.0f; }
+
+        inline PerfCounters& operator+=(const PerfCounters& other)
+        {
+            cycles += other.cycles;
+            instructions += other.instructions;
+            cacheMisses += other.cacheMisses;
+            branchMisses += other.branchMisses;
+            return *this;
+        }
+    };
+
     struct CPURecord
     {
         std::string_view name;
+        uint64_t id = 0;
         float lastWrite = 0.0f;
         int depth = 0;
-        float delta = 0.0f;
-        float time = 0.0f;
+        uint32_t threadIndex = 0;
+        uint32_t calls = 0; // this frame, 0 when the scope did not run
+        float delta = 0.0f; // ms, summed over the calls of this frame
+        uint32_t allocations = 0; // this frame, made while the scope was the innermost one
+        uint64_t allocatedBytes = 0;
+        PerfCounters counters;    // this frame, summed over the calls
+        float time = 0.0f;  // ms, averaged over Application::ApplicationContext::averageTimeUpdateInterval
         float timeSum = 0.0;
+        FrameHistory history;
+    };
+
+    // a closed CPU scope, in GetTicks() units
+    struct CPUEvent
+    {
+        std::string_view name;
+        uint64_t id = 0;
+        uint64_t start = 0;
+        uint64_t end = 0;
+        int depth = 0;
+        uint32_t allocations = 0;
+        uint64_t allocatedBytes = 0;
+        PerfCounters counters;
+    };
+
+    struct CaptureEvent
+    {
+        CPUEvent event;
+        uint32_t threadIndex = 0;
     };
 
     struct GPURecord
@@ -1316,18 +1569,68 @@ namespace Profiler {
         float delta = 0.0f;
         float time = 0.0f;
         float timeSum = 0.0;
+        FrameHistory history;
     };
 
     struct CPUScope
     {
         std::string_view name;
-        float start;
-        int index = 0;
+        uint64_t id;
+        uint64_t start;
+        int depth = 0;
+        CPUScope* parent = nullptr;
+        uint32_t allocations = 0;
+        uint64_t allocatedBytes = 0;
+        PerfCounters counters; // at Begin(), then the difference
+
+        CPUScope(std::string_view pName, std::source_location location = std::source_location::current())
+            : name(pName)
+            , id(MakeScopeID(pName, location.file_name(), location.line(), location.column()))
+        {
+            Begin();
+        }
 
-        CORE_API CPUScope(std::string_view pName);
+        CORE_API void Begin();
         CORE_API ~CPUScope();
     };
 
+    // One per thread that opened a CPU scope. The owning thread pushes closed scopes into 'events' (single producer, lock free),
+    // Profiler::EndFrame() drains them on the main thread (single consumer) and turns them into 'records'.
+    struct CPUThreadBuffer
+    {
+        static constexpr uint32_t c_Capacity = 4096;  // power of two
+        static constexpr uint32_t c_MaxRecords = 256; // distinct scopes per thread, preallocated on registration
+        static constexpr uint32_t c_TableSize = 512;  // power of two, at least twice c_MaxRecords
+
+        std::string name;
+        uint32_t threadIndex = 0;
+
+        // producer side
+        int depth = 0;
+        std::stack<CPUScope> stack; // CPUBegin/CPUEnd
+        CPUScope* current = nullptr; // innermost open scope, allocations are attributed to it
+        std::atomic<uint64_t> allocations = 0; // totals, only written by the owning thread
+        std::atomic<uint64_t> allocatedBytes = 0;
+        std::atomic<uint64_t> frees = 0;
+        int perfGroup = -1;       // perf_event_open group leader, the other counters are read through it
+        int perfEvents[4] = { -1, -1, -1, -1 };
+        bool perfOpened = false;  // tried once per thread
+        alignas(64) std::atomic<uint32_t> head = 0;
+
+        // consumer side
+        alignas(64) std::atomic<uint32_t> tail = 0;
+        std::atomic<uint32_t> dropped = 0; // events lost because the ring was full or the thread opened more than c_MaxRecords distinct scopes
+        std::vector<CPURecord> records;      // one per scope ID, in the order they were first seen
+        int recordCount = 0;
+        std::array<uint32_t, c_TableSize> recordTable = {}; // scope ID -> record index + 1, open addressing
+        std::vector<uint32_t> frameRecords;  // records that ran this frame, in the order they were opened
+        uint64_t lastAllocations = 0;
+        uint64_t lastAllocatedBytes = 0;
+        uint64_t lastFrees = 0;
+
+        std::array<CPUEvent, c_Capacity> events;
+    };
+
     struct GPUScope
     {
         nvrhi::IDevice* device;
@@ -1341,7 +1644,36 @@ namespace Profiler {
 
     void BeginFrame();
     void EndFrame();
-    CORE_API void CPUBegin(std::string_view pName);
+
+    // The profiler clock, the invariant TSC when the CPU has one (calibrated once at startup), otherwise a raw monotonic clock.
+    // Ticks are 64 bit and only converted to milliseconds in EndFrame().
+    CORE_API uint64_t GetTicks();
+    CORE_API double TicksToMilliseconds(uint64_t ticks);
+    CORE_API bool IsUsingTSC();
+
+    // Average cost in nanoseconds of one BUILTIN_PROFILE_CPU scope on the calling thread. Call it between frames,
+    // the scopes the calling thread closed and EndFrame() did not merge yet are discarded with the measurement ones.
+    CORE_API double MeasureCPUScopeOverhead(uint32_t iterations = 100000);
+
+    // min/max/percentiles over the recorded frames, sorted on a stack copy so it can be called any time
+    CORE_API FrameStats ComputeFrameStats(const FrameHistory& history);
+
+    // a sample is a hitch when it is above 'factor' times the mean of its history and at least 'minimumMs' long
+    CORE_API void SetHitchThreshold(float factor, float minimumMs);
+
+    // Linux only, reads cycles, instructions, LLC misses and branch misses at every scope boundary through a
+    // perf_event_open group (one read syscall each side). Returns false when the counters are not available.
+    CORE_API bool EnablePerfCounters(bool enable);
+    CORE_API bool IsUsingPerfCounters();
+
+    // Capture of every CPU scope and Jops task span into a buffer of 'maxEvents' allocated up front, events past it are dropped.
+    // Main thread only, both wait for the running Jops tasks. WriteCapture() writes Chrome trace event JSON, it opens in Perfetto or chrome://tracing.
+    CORE_API void BeginCapture(uint32_t maxEvents = 1 << 20);
+    CORE_API void EndCapture();
+    CORE_API bool IsCapturing();
+    CORE_API bool WriteCapture(const std::filesystem::path& filePath);
+
+    CORE_API void CPUBegin(std::string_view pName, std::source_location location = std::source_location::current());
     CORE_API void CPUEnd();
     CORE_API void GPUBegin(nvrhi::IDevice* pDevice, nvrhi::ICommandList* pCommandList, std::string_view pName);
     CORE_API void GPUEnd();
@@ -1354,15 +1686,706 @@ namespace Profiler {
 namespace Jops {
 
     using Taskflow = tf::Taskflow;
-    using Task = tf::Task;
+    using GraphTask = tf::Task; // Task<T> is the coroutine
     using Executor = tf::Executor;
     using Future = tf::Future<void>;
 
+    // one frame of a queue, latencies are enqueue -> start
+    struct QueueStats
+    {
+        uint32_t count = 0;    // started this frame
+        float latencyMean = 0.0f; // ms
+        float latencyMax = 0.0f;
+        float runMean = 0.0f;
+        float runMax = 0.0f;
+        uint32_t depth = 0;    // submitted and not started at the end of the frame
+        uint32_t maxDepth = 0; // peak during the frame
+    };
+
+    // written by the submitting and the running threads, turned into QueueStats and reset every frame
+    struct QueueCounters
+    {
+        std::atomic<uint32_t> count = 0;
+        std::atomic<uint64_t> latencySum = 0; // Profiler::GetTicks() units
+        std::atomic<uint64_t> latencyMax = 0;
+        std::atomic<uint64_t> runSum = 0;
+        std::atomic<uint64_t> runMax = 0;
+        std::atomic<uint32_t> depth = 0;
+        std::atomic<uint32_t> maxDepth = 0;
+    };
+
+    using Job = Core::InlineFunction<void(), 64>;
+
+    enum class Priority : uint8_t
+    {
+        FrameCritical, // needed by the next frame, runs before anything else queued
+        Normal,
+        Background,    // long work such as asset decodes, should call YieldIfNeeded() between steps
+
+        Count
+    };
+
+    constexpr uint64_t c_NoDeadline = ~0ull;
+
+    struct QueuedJob
+    {
+        Job function;
+        uint64_t enqueueTicks = 0;
+        uint64_t deadlineFrame = c_NoDeadline; // Application::GetFrameIndex() it has to finish in
+        uint64_t sequence = 0;
+    };
+
+    // jobs of one priority, earliest deadline first then submission order
+    struct Lane
+    {
+        std::vector<QueuedJob*> heap;
+        std::mutex mutex;
+        std::atomic<uint32_t> pending = 0;
+    };
+
+    // Objects recycled through a lock-free free list (tagged indices, no ABA), memory is only allocated when the pool
+    // grows by a block of c_BlockSize objects and is released with the pool. Allocate()/Free() from any thread.
+    template<typename T>
+    class TaskPool
+    {
+    public:
+        TaskPool() = default;
+        TaskPool(const TaskPool&) = delete;
+        TaskPool& operator=(const TaskPool&) = delete;
+
+        ~TaskPool()
+        {
+            for (uint32_t i = 0; i < m_BlockCount.load(std::memory_order_acquire); i++)
+                delete[] m_Blocks[i].load(std::memory_order_relaxed);
+        }
+
+        template<typename... Args>
+        T* Allocate(Args&&... args)
+        {
+            uint64_t head = m_FreeList.load(std::memory_order_acquire);
+
+            while (true)
+            {
+                const uint32_t index = uint32_t(head);
+                if (!index)
+                {
+                    Grow();
+                    head = m_FreeList.load(std::memory_order_acquire);
+                    continue;
+                }
+
+                // a slot is never freed, reading a stale 'next' is harmless, the tag makes the exchange fail
+                Slot& slot = GetSlot(index - 1);
+                const uint64_t next = ((head >> 32) + 1) << 32 | slot.next.load(std::memory_order_relaxed);
+
+                if (m_FreeList.compare_exchange_weak(head, next, std::memory_order_acquire, std::memory_order_acquire))
+                    return new (slot.storage) T{ std::forward<Args>(args)... };
+            }
+        }
+
+        void Free(T* object)
+        {
+            object->~T();
+
+            Slot& slot = *reinterpret_cast<Slot*>(object);
+            uint64_t head = m_FreeList.load(std::memory_order_relaxed);
+            uint64_t next;
+
+            do
+            {
+                slot.next.store(uint32_t(head), std::memory_order_relaxed);
+                next = ((head >> 32) + 1) << 32 | (slot.index + 1);
+            } while (!m_FreeList.compare_exchange_weak(head, next, std::memory_order_release, std::memory_order_relaxed));
+        }
+
+    private:
+        static constexpr uint32_t c_BlockSize = 1024;
+        static constexpr uint32_t c_MaxBlocks = 4096;
+
+        struct Slot
+        {
+            alignas(T) std::byte storage[sizeof(T)];
+            std::atomic<uint32_t> next = 0; // free list link, slot index + 1, 0 ends the list
+            uint32_t index = 0;
+        };
+
+        Slot& GetSlot(uint32_t index)
+        {
+            return m_Blocks[index / c_BlockSize].load(std::memory_order_acquire)[index % c_BlockSize];
+        }
+
+        void Grow()
+        {
+            std::scoped_lock<std::mutex> lock(m_GrowMutex);
+
+            if (uint32_t(m_FreeList.load(std::memory_order_acquire)))
+                return;
+
+            const uint32_t blockIndex = m_BlockCount.load(std::memory_order_relaxed);
+            CORE_VERIFY(blockIndex < c_MaxBlocks, "TaskPool : too many objects alive");
+
+            Slot* block = new Slot[c_BlockSize];
+            const uint32_t first = blockIndex * c_BlockSize;
+            for (uint32_t i = 0; i < c_BlockSize; i++)
+            {
+                block[i].index = first + i;
+                block[i].next.store(i + 1 < c_BlockSize ? first + i + 2 : 0, std::memory_order_relaxed);
+            }
+
+            m_Blocks[blockIndex].store(block, std::memory_order_release);
+            m_BlockCount.store(blockIndex + 1, std::memory_order_release);
+
+            // the list may have been refilled by Free() meanwhile, append it after the new block
+            uint64_t head = m_FreeList.load(std::memory_order_relaxed);
+            uint64_t next;
+            do
+            {
+                block[c_BlockSize - 1].next.store(uint32_t(head), std::memory_order_relaxed);
+                next = ((head >> 32) + 1) << 32 | (first + 1);
+            } while (!m_FreeList.compare_exchange_weak(head, next, std::memory_order_release, std::memory_order_relaxed));
+        }
+
+        std::atomic<uint64_t> m_FreeList = 0; // tag << 32 | (slot index + 1)
+        std::atomic<uint32_t> m_BlockCount = 0;
+        std::array<std::atomic<Slot*>, c_MaxBlocks> m_Blocks = {};
+        std::mutex m_GrowMutex;
+    };
+
+    // Unbounded multi-producer/single-consumer queue (Vyukov) with pooled nodes. Push() is one atomic exchange,
+    // TryPop() never blocks, a value pushed while the consumer runs may only show up on its next TryPop().
+    template<typename T>
+    class MPSCQueue
+    {
+    public:
+        MPSCQueue() = default;
+        MPSCQueue(const MPSCQueue&) = delete;
+        MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+        ~MPSCQueue()
+        {
+            T value;
+            while (TryPop(value));
+
+            if (m_Tail != &m_Stub)
+                m_Pool.Free(m_Tail);
+        }
+
+        void Push(T&& value)
+        {
+            Node* node = m_Pool.Allocate(nullptr, std::move(value));
+
+            Node* prev = m_Head.exchange(node, std::memory_order_acq_rel);
+            prev->next.store(node, std::memory_order_release);
+        }
+
+        // consumer only
+        bool TryPop(T& out)
+        {
+            Node* tail = m_Tail;
+            Node* next = tail->next.load(std::memory_order_acquire);
+            if (!next)
+                return false;
+
+            // 'next' becomes the new stub, its value is moved out
+            out = std::move(next->value);
+            m_Tail = next;
+
+            if (tail != &m_Stub)
+                m_Pool.Free(tail);
+
+            return true;
+        }
+
+    private:
+        struct Node
+        {
+            std::atomic<Node*> next = nullptr;
+            T value;
+        };
+
+        TaskPool<Node> m_Pool;
+        Node m_Stub;
+        alignas(64) std::atomic<Node*> m_Head = &m_Stub; // producers
+        alignas(64) Node* m_Tail = &m_Stub;              // consumer
+    };
+
+    enum class Pinning : uint8_t
+    {
+        None, // the OS places the workers
+        Node, // each worker runs on the CPUs of one NUMA node, the nodes are filled one after the other
+        Core, // each worker runs on one CPU, in NUMA node order
+    };
+
+    struct ExecutorDesc
+    {
+        Pinning pinning = Pinning::None;
+        bool skipSMTSiblings = true; // one CPU per physical core, workers wrap around when there are more of them
+        bool pinMainThread = false;  // on the first CPU (or node), the workers are placed after it
+    };
+
+    constexpr int32_t c_AnyNode = -1;
+
+    CORE_API uint32_t GetNodeCount();
+    // the NUMA node the calling thread is pinned to, or the one it currently runs on
+    CORE_API int32_t GetCurrentNode();
+
+    enum class Chunking : uint8_t
+    {
+        Adaptive,  // grain from the measured cost of the first items
+        CacheLine, // same, every chunk starts on a cache line and covers whole lines, for passes writing to the items
+    };
+
+    using ChunkFunction = void(*)(void* context, size_t begin, size_t end);
+
+    // shared by the threads running the chunks of one ParallelFor, pooled and released by the last one out
+    struct ParallelState
+    {
+        std::atomic<size_t> next = 0; // next chunk to claim
+        std::atomic<size_t> done = 0; // chunks finished
+        std::atomic<uint32_t> references = 0;
+        size_t begin = 0;
+        size_t end = 0;
+        size_t grain = 1;
+        size_t chunkCount = 0;
+        ChunkFunction chunk = nullptr;
+        void* context = nullptr;
+        int32_t node = c_AnyNode; // only the workers of this node claim chunks
+    };
+
+    CORE_API Executor& GetExecutor();
+
+    // splits [begin, end) in chunks of 'grain' items, the calling thread runs chunks too and only waits for the ones
+    // already claimed by workers, so it is safe to call from a worker and never deadlocks on a busy executor
+    CORE_API void ParallelRun(size_t begin, size_t end, size_t grain, ChunkFunction chunk, void* context, int32_t node = c_AnyNode);
+
+    // fn(std::span<T> chunk). The first items run on the calling thread to measure their cost, the rest is split in
+    // chunks of about 50us, or kept on the calling thread when it is too cheap to be worth spreading.
+    // 'node' keeps the workers of other NUMA nodes out, GetCurrentNode() for memory first touched by the caller.
+    template<typename T, typename Fn>
+    void ParallelForChunks(std::span<T> range, Fn&& fn, Chunking chunking = Chunking::Adaptive, int32_t node = c_AnyNode)
+    {
+        constexpr double c_ProbeNs = 20'000.0;
+        constexpr double c_ChunkNs = 50'000.0;
+        constexpr double c_SerialNs = 100'000.0;
+
+        const size_t count = range.size();
+        size_t processed = 0;
+        double elapsedNs = 0.0;
+
+        // batches of 1, 2, 4... items, a single expensive item is enough to decide
+        const uint64_t probeStart = Profiler::GetTicks();
+        for (size_t batch = 1; processed < count && elapsedNs < c_ProbeNs; batch *= 2)
+        {
+            const size_t n = std::min(batch, count - processed);
+            fn(range.subspan(processed, n));
+            processed += n;
+            elapsedNs = Profiler::TicksToMilliseconds(Profiler::GetTicks() - probeStart) * 1e6;
+        }
+
+        if (processed == count)
+            return;
+
+        const double itemNs = std::max(elapsedNs / double(processed), 0.1);
+        const size_t remaining = count - processed;
+        if (double(remaining) * itemNs < c_SerialNs)
+        {
+            fn(range.subspan(processed));
+            return;
+        }
+
+        // at least 4 chunks per thread so a slow worker does not hold the others back
+        const size_t threads = GetExecutor().num_workers() + 1;
+        size_t grain = std::clamp<size_t>(size_t(c_ChunkNs / itemNs), 1, std::max<size_t>(remaining / (threads * 4), 1));
+
+        if (chunking == Chunking::CacheLine)
+        {
+            constexpr size_t c_CacheLine = 64;
+            constexpr size_t c_LineItems = c_CacheLine / std::gcd(c_CacheLine, sizeof(T)); // items per whole number of lines
+
+            // run up to the first item starting a line, the chunks after it never share a line
+            size_t aligned = processed;
+            while (aligned < count && aligned < processed + c_LineItems && uintptr_t(range.data() + aligned) % c_CacheLine)
+                aligned++;
+
+            if (aligned < count && uintptr_t(range.data() + aligned) % c_CacheLine == 0 && aligned > processed)
+            {
+                fn(range.subspan(processed, aligned - processed));
+                processed = aligned;
+            }
+
+            grain = (grain + c_LineItems - 1) / c_LineItems * c_LineItems;
+        }
+
+        struct Context
+        {
+            std::span<T> range;
+            std::remove_reference_t<Fn>& fn;
+        };
+
+        Context context = { range, fn };
+        ParallelRun(processed, count, grain, [](void* context, size_t begin, size_t end) {
+            auto& c = *static_cast<Context*>(context);
+            c.fn(c.range.subspan(begin, end - begin));
+        }, &context, node);
+    }
+
+    // fn(T& item)
+    template<typename T, typename Fn>
+    void ParallelFor(std::span<T> range, Fn&& fn, Chunking chunking = Chunking::Adaptive, int32_t node = c_AnyNode)
+    {
+        ParallelForChunks(range, [&fn](std::span<T> chunk) {
+            for (T& item : chunk)
+                fn(item);
+        }, chunking, node);
+    }
+
+    // combine(R, map(T&)), combine must be associative and commutative, chunks are merged in any order
+    template<typename T, typename R, typename Map, typename Combine>
+    R ParallelReduce(std::span<T> range, R identity, Map&& map, Combine&& combine, Chunking chunking = Chunking::Adaptive, int32_t node = c_AnyNode)
+    {
+        R result = identity;
+        std::mutex mutex;
+
+        // one lock per chunk, chunks are coarse enough for it not to matter
+        ParallelForChunks(range, [&](std::span<T> chunk) {
+            R partial = identity;
+            for (T& item : chunk)
+                partial = combine(std::move(partial), map(item));
+
+            std::scoped_lock<std::mutex> lock(mutex);
+            result = combine(std::move(result), std::move(partial));
+        }, chunking, node);
+
+        return result;
+    }
+
     CORE_API std::future<void> SubmitTask(const std::function<void()>& function);
+
+    // fire and forget on a worker, the job lives in a pooled node, nothing is allocated once the pool is warm.
+    // Every worker picks the most urgent queued job, lanes in priority order. A job still running after the end of
+    // frame 'deadlineFrame' counts in Stats::missedDeadlines, it is not cancelled.
+    CORE_API void Submit(Job&& job, Priority priority, uint64_t deadlineFrame = c_NoDeadline);
+    CORE_API void Submit(Job&& job); // Priority::Normal
+    // true when frame-critical jobs are waiting, for long jobs to split their work on
+    CORE_API bool ShouldYield();
+    // runs the waiting frame-critical jobs on the calling thread, returns false when there was none
+    CORE_API bool YieldIfNeeded();
     CORE_API Future RunTaskflow(Taskflow& taskflow);
     CORE_API void WaitForAll();
-    CORE_API void SetMainThreadMaxJobsPerFrame(uint32_t max);
-    CORE_API void SubmitToMainThread(const std::function<void()>& function);
+    // time the main thread spends on SubmitToMainThread() jobs each frame, at least one job runs per frame
+    CORE_API void SetMainThreadJobBudget(uint32_t microseconds);
+    CORE_API void SubmitToMainThread(Job&& job);
+    CORE_API void SubmitToMainThread(const std::function<void()>& function); // boxed into a Job
+
+    // a lambda converts to both overloads above, it goes straight into a Job
+    template<typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, Job> && !std::is_same_v<std::decay_t<F>, std::function<void()>>>>
+    void SubmitToMainThread(F&& function) { SubmitToMainThread(Job(std::forward<F>(function))); }
+
+    CORE_API bool IsMainThread();
+
+    // fn(tf::Subflow& subflow, const Core::FrameInfo& info), may spawn its own subgraph in 'subflow'
+    using FrameTaskFunction = Core::InlineFunction<void(tf::Subflow&, const Core::FrameInfo&), 64>;
+
+    // Tasks declared by the layers every frame, run as one taskflow. A task waits for the earlier tasks writing what
+    // it reads or writes and for the earlier readers of what it writes, tasks on disjoint resources run in parallel.
+    // The taskflow is cached and only rebuilt when the declarations (names, reads, writes) change.
+    class FrameGraph
+    {
+    public:
+        FrameGraph() = default;
+        FrameGraph(const FrameGraph&) = delete;
+        FrameGraph& operator=(const FrameGraph&) = delete;
+
+        // 'name' must outlive the frame, a literal
+        CORE_API void AddTask(std::string_view name, std::initializer_list<std::string_view> reads, std::initializer_list<std::string_view> writes, FrameTaskFunction&& function);
+        // runs the declared tasks and waits for them, then clears the declarations
+        CORE_API void Run(const Core::FrameInfo& info);
+
+        uint32_t GetTaskCount() const { return uint32_t(m_Tasks.size()); }
+        uint32_t GetRebuildCount() const { return m_RebuildCount; }
+
+    private:
+        static constexpr uint64_t c_EmptyHash = 14695981039346656037ull;
+
+        struct FrameTask
+        {
+            std::string_view name;
+            uint32_t firstResource = 0; // in m_Resources, the reads then the writes
+            uint32_t readCount = 0;
+            uint32_t writeCount = 0;
+            FrameTaskFunction function;
+        };
+
+        void Rebuild();
+
+        std::vector<FrameTask> m_Tasks;
+        std::vector<uint64_t> m_Resources;
+        uint64_t m_Hash = c_EmptyHash;
+        uint64_t m_BuiltHash = c_EmptyHash;
+        Taskflow m_Taskflow;
+        const Core::FrameInfo* m_Info = nullptr;
+        uint32_t m_RebuildCount = 0;
+    };
+
+    // coroutine frames up to 2KB come from size-class pools, larger ones from the heap
+    CORE_API void* AllocateCoroutineFrame(size_t size);
+    CORE_API void FreeCoroutineFrame(void* frame, size_t size);
+    // A coroutine waiting for the main thread. 'owner' is the detached task at the root of the coroutines awaiting it,
+    // destroyed with the ParkedCoroutine when the application shuts down before the resume. A chain owned by a Task object is left to it.
+    struct ParkedCoroutine
+    {
+        std::coroutine_handle<> handle;
+        std::coroutine_handle<> owner;
+
+        ParkedCoroutine() = default;
+        ParkedCoroutine(std::coroutine_handle<> pHandle, std::coroutine_handle<> pOwner) : handle(pHandle), owner(pOwner) {}
+        ParkedCoroutine(ParkedCoroutine&& other) noexcept : handle(std::exchange(other.handle, {})), owner(std::exchange(other.owner, {})) {}
+        ParkedCoroutine(const ParkedCoroutine&) = delete;
+        ParkedCoroutine& operator=(const ParkedCoroutine&) = delete;
+
+        ParkedCoroutine& operator=(ParkedCoroutine&& other) noexcept
+        {
+            std::swap(handle, other.handle);
+            std::swap(owner, other.owner);
+            return *this;
+        }
+
+        ~ParkedCoroutine()
+        {
+            if (owner)
+                owner.destroy();
+        }
+
+        void Resume()
+        {
+            owner = {};
+            std::exchange(handle, {}).resume();
+        }
+    };
+
+    // resumed by the main thread at the start of the next frame
+    CORE_API void ResumeNextFrame(std::coroutine_handle<> handle, std::coroutine_handle<> owner = {});
+
+    template<typename T = void>
+    class Task;
+
+    namespace Detail {
+
+        struct PromiseBase
+        {
+            std::coroutine_handle<> continuation;
+            PromiseBase* parent = nullptr; // the awaiting coroutine when it is a Task too, see GetDetachedOwner()
+            std::coroutine_handle<> self;
+            std::exception_ptr exception;
+            bool detached = false;
+
+            static void* operator new(size_t size) { return AllocateCoroutineFrame(size); }
+            static void operator delete(void* frame, size_t size) { FreeCoroutineFrame(frame, size); }
+
+            // continues the awaiting coroutine on the same thread, or frees a detached task
+            struct FinalAwaiter
+            {
+                bool await_ready() const noexcept { return false; }
+                void await_resume() const noexcept {}
+
+                template<typename Promise>
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) const noexcept
+                {
+                    PromiseBase& promise = handle.promise();
+                    if (promise.continuation)
+                        return promise.continuation;
+
+                    if (promise.detached)
+                    {
+                        if (promise.exception)
+                            LOG_CORE_ERROR("Jops::Task : unhandled exception in a detached task");
+
+                        handle.destroy();
+                    }
+
+                    return std::noop_coroutine();
+                }
+            };
+
+            std::suspend_always initial_suspend() const noexcept { return {}; }
+            FinalAwaiter final_suspend() const noexcept { return {}; }
+            void unhandled_exception() { exception = std::current_exception(); }
+        };
+
+        template<typename T>
+        struct Promise : PromiseBase
+        {
+            std::optional<T> value;
+
+            Task<T> get_return_object();
+
+            template<typename U>
+            void return_value(U&& v) { value.emplace(std::forward<U>(v)); }
+
+            T Result()
+            {
+                if (exception)
+                    std::rethrow_exception(exception);
+
+                return std::move(*value);
+            }
+        };
+
+        template<>
+        struct Promise<void> : PromiseBase
+        {
+            Task<void> get_return_object();
+
+            void return_void() {}
+
+            void Result()
+            {
+                if (exception)
+                    std::rethrow_exception(exception);
+            }
+        };
+    }
+
+    // Lazy coroutine, starts when awaited or detached. The awaiting coroutine continues on the thread that finished
+    // the task, hop back with ResumeOnMainThread() when needed.
+    template<typename T>
+    class Task
+    {
+    public:
+        using promise_type = Detail::Promise<T>;
+        using Handle = std::coroutine_handle<promise_type>;
+
+        Task() = default;
+        explicit Task(Handle handle) : m_Handle(handle) {}
+        Task(Task&& other) noexcept : m_Handle(std::exchange(other.m_Handle, {})) {}
+        Task(const Task&) = delete;
+        Task& operator=(const Task&) = delete;
+
+        Task& operator=(Task&& other) noexcept
+        {
+            if (this != &other)
+            {
+                if (m_Handle)
+                    m_Handle.destroy();
+
+                m_Handle = std::exchange(other.m_Handle, {});
+            }
+            return *this;
+        }
+
+        ~Task()
+        {
+            if (m_Handle)
+                m_Handle.destroy();
+        }
+
+        // a member class, a local one can't have the await_suspend template
+        struct Awaiter
+        {
+            Handle handle;
+
+            bool await_ready() const noexcept { return !handle || handle.done(); }
+
+            template<typename AwaitingPromise>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<AwaitingPromise> awaiting) const noexcept
+            {
+                handle.promise().continuation = awaiting;
+                if constexpr (std::is_base_of_v<Detail::PromiseBase, AwaitingPromise>)
+                    handle.promise().parent = &awaiting.promise();
+
+                return handle;
+            }
+
+            T await_resume() const { return handle.promise().Result(); }
+        };
+
+        Awaiter operator co_await() const noexcept { return Awaiter{ m_Handle }; }
+
+        // starts the task on the calling thread without waiting for it, the frame is freed when it completes
+        void Detach()
+        {
+            Handle handle = std::exchange(m_Handle, {});
+            handle.promise().detached = true;
+            handle.resume();
+        }
+
+        bool IsDone() const { return !m_Handle || m_Handle.done(); }
+
+    private:
+        Handle m_Handle;
+    };
+
+    namespace Detail {
+
+        template<typename T>
+        Task<T> Promise<T>::get_return_object()
+        {
+            auto handle = std::coroutine_handle<Promise<T>>::from_promise(*this);
+            self = handle;
+            return Task<T>(handle);
+        }
+
+        inline Task<void> Promise<void>::get_return_object()
+        {
+            auto handle = std::coroutine_handle<Promise<void>>::from_promise(*this);
+            self = handle;
+            return Task<void>(handle);
+        }
+
+        // the detached task at the root of the Tasks awaiting 'handle', none when a Task object owns them
+        template<typename Promise>
+        std::coroutine_handle<> GetDetachedOwner(std::coroutine_handle<Promise> handle)
+        {
+            if constexpr (std::is_base_of_v<PromiseBase, Promise>)
+            {
+                PromiseBase* root = &handle.promise();
+                while (root->parent)
+                    root = root->parent;
+
+                return root->detached ? root->self : std::coroutine_handle<>();
+            }
+            else
+            {
+                return {};
+            }
+        }
+    }
+
+    // co_await ResumeOnWorker() continues on a worker, through Submit() and its lanes
+    struct ResumeOnWorker
+    {
+        Priority priority = Priority::Normal;
+        uint64_t deadlineFrame = c_NoDeadline;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) const { Submit([handle]() { handle.resume(); }, priority, deadlineFrame); }
+        void await_resume() const noexcept {}
+    };
+
+    // continues on the main thread, with the SubmitToMainThread() jobs, right away when already there
+    struct ResumeOnMainThread
+    {
+        bool await_ready() const noexcept { return IsMainThread(); }
+
+        template<typename Promise>
+        void await_suspend(std::coroutine_handle<Promise> handle) const
+        {
+            SubmitToMainThread([parked = ParkedCoroutine(handle, Detail::GetDetachedOwner(handle))]() mutable { parked.Resume(); });
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    // continues on the main thread at the start of the next frame, before the SubmitToMainThread() jobs
+    struct NextFrame
+    {
+        bool await_ready() const noexcept { return false; }
+
+        template<typename Promise>
+        void await_suspend(std::coroutine_handle<Promise> handle) const { ResumeNextFrame(handle, Detail::GetDetachedOwner(handle)); }
+
+        void await_resume() const noexcept {}
+    };
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -1459,14 +2482,35 @@ namespace Application {
         ApplicationCommandLineArgs commandLineArgs;
         std::filesystem::path workingDirectory;
         bool createDefaultDevice = true;
+        bool headless = false;          // no window, no GLFW and no device (createDefaultDevice is ignored), time from a monotonic clock
+        float headlessUpdateRate = 0.0f; // Hz, 0 runs the frames back to back
         uint32_t workersNumber = std::thread::hardware_concurrency() - 1;
+        Jops::ExecutorDesc executorDesc;
         std::filesystem::path logFile = "Core";
+        std::filesystem::path profilerCaptureFile; // when set, the built-in profiler captures from startup and writes it here at shutdown
+        bool pipelinedUpdate = false; // Layer::OnParallelUpdate of frame N+1 runs on a worker during OnUpdate/OnEnd/Present of frame N
+        float fixedTimestep = 0.0f;   // seconds, 0 disables Layer::OnFixedUpdate
+        uint32_t maxFixedSteps = 5;   // per frame, the time left over after them is dropped instead of caught up
     };
 
     struct Stats
     {
         float CPUMainTime;
         uint32_t FPS;
+
+        // last frame, all threads, only counted with CORE_TRACK_ALLOCATIONS
+        uint32_t allocations;
+        uint64_t allocatedBytes;
+        uint32_t frees;
+
+        // last frame, Jops::SubmitTask on the workers and Jops::SubmitToMainThread
+        Jops::QueueStats workerTasks;
+        Jops::QueueStats mainThreadJobs;
+        uint32_t missedDeadlines; // Jops::Submit jobs finished after the end of their deadline frame
+
+        // last frame, with ApplicationDesc::fixedTimestep
+        uint32_t fixedSteps;
+        uint32_t droppedFixedSteps; // beyond maxFixedSteps
     };
 
     struct ApplicationContext
@@ -1482,18 +2526,40 @@ namespace Application {
         std::map<uint64_t, Core::KeyBindingDesc> keyBindings;
         bool blockingEventsUntilNextFrame = false;
 
-        // threads
+        // profiler, declared before the executor since workers may still close scopes while it drains on destruction
+        std::vector<std::unique_ptr<Profiler::CPUThreadBuffer>> cpuProfilerThreads;
+        std::mutex cpuProfilerThreadsMutex;
+        uint32_t cpuProfilerGeneration = 0;
+
+        // threads, all declared before the executor, tasks still running while it drains on destruction may use any of them
+        Jops::QueueCounters workerTaskCounters;
+        Jops::QueueCounters mainThreadJobCounters;
+        Jops::TaskPool<Jops::QueuedJob> workerJobPool;
+        std::array<Jops::Lane, size_t(Jops::Priority::Count)> jobLanes;
+        std::atomic<uint64_t> jobSequence = 0;
+        std::atomic<uint32_t> missedDeadlines = 0;
+        std::vector<Core::Layer*> parallelLayers; // the layers the running OnParallelUpdate goes through
+        Core::FrameInfo parallelUpdateInfo = {};
+        std::atomic<bool> parallelUpdateRunning = false;
+        Jops::TaskPool<Jops::ParallelState> parallelStatePool;
+        uint32_t mainThreadJobBudget = 2000; // us
+        Jops::MPSCQueue<Jops::QueuedJob> mainThreadQueue;
+        std::thread::id mainThreadId;
+        std::vector<Jops::ParkedCoroutine> nextFrameCoroutines;
+        std::vector<Jops::ParkedCoroutine> resumingCoroutines; // main thread only, swapped with the list above
+        std::mutex nextFrameCoroutinesMutex;
+        Jops::FrameGraph frameGraph;
         tf::Executor executor;
-        uint32_t mainThreadMaxJobsPerFrame = 1;
-        std::queue<std::function<void()>> mainThreadQueue;
-        std::mutex mainThreadQueueMutex;
 
-        // profiler
-        std::vector<Profiler::CPURecord> cpuProfilerRecords;
-        std::stack<Profiler::CPUScope> cpuProfilerStack;
-        int cpuProfilerRecordCount = 0;
-        int cpuProfilerDepth = 0;
-        int cpuProfilerIndex = 0;
+        float profilerHitchFactor = 2.0f;
+        float profilerHitchMinimum = 1.0f; // ms
+
+        std::vector<Profiler::CaptureEvent> profilerCapture;
+        uint32_t profilerCaptureDropped = 0;
+        bool profilerCapturing = false;
+        std::shared_ptr<tf::ObserverInterface> profilerTaskObserver; // attached while capturing
+        std::unordered_set<std::string> profilerTaskNames;
+        std::mutex profilerTaskNamesMutex;
 
         std::vector<Profiler::GPURecord> gpuProfilerRecords;
         std::stack<Profiler::GPUScope> gpuProfilerStack;
@@ -1503,6 +2569,10 @@ namespace Application {
 
         Stats appStats;
         bool running = true;
+        std::atomic<uint64_t> frameIndex = 0; // read by workers to check deadlines
+        double fixedAccumulator = 0.0;        // seconds not simulated yet
+        std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now(); // GetTime() when headless
+        std::chrono::steady_clock::time_point nextHeadlessFrame;
         float lastFrameTime = 0.0f;
         float frameTimestamp = 0.0f;
         float averageFrameTime = 0.0;
@@ -1514,6 +2584,7 @@ namespace Application {
         inline static ApplicationContext* s_Instance = nullptr;
 
         CORE_API ApplicationContext(const ApplicationDesc& desc);
+        CORE_API ~ApplicationContext();
         CORE_API void Run();
     };
 
@@ -1526,6 +2597,7 @@ namespace Application {
     CORE_API void PopOverlay(Core::Layer* overlay);
     CORE_API float GetTime();
     CORE_API const Stats& GetStats();
+    CORE_API uint64_t GetFrameIndex();
     CORE_API const ApplicationDesc& GetApplicationDesc();
     CORE_API float GetAverageFrameTimeSeconds();
     CORE_API float GetLastFrameTime();
@@ -1605,7 +2677,10 @@ namespace Meta {
         Bool , Bool2 , Bool3 , Bool4 ,
 
         Uint8, Uint16, Uint64,
-        Int8 , Int16 , Int64
+        Int8 , Int16 , Int64 ,
+
+        Struct, // a reflected TYPE(), see Type::ChildType()
+        Enum,   // a reflected TYPE() enum, see Type::ChildEnum()
     };
 
     struct Field
@@ -1618,6 +2693,7 @@ namespace Meta {
         uint32_t attributesOffset;
         uint8_t attributesCount;
         Attribute* attributes = nullptr;
+        uint32_t typeIndex = 0; // index of the child type (FieldType::Struct) or enum (FieldType::Enum) in the registry
 
         template<typename ReturnType, typename Type>
         inline ReturnType& Value(Type& type) const 
@@ -1633,20 +2709,289 @@ namespace Meta {
         }
     };
 
+    // FNV-1a, the Meta tool uses the same hash to precompute the enum lookup tables
+    inline constexpr uint64_t HashName(std::string_view name)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        for (char c : name)
+        {
+            hash ^= (uint8_t)c;
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    struct EnumValue
+    {
+        std::string_view name;
+        int64_t value = 0;
+        uint64_t hash = 0;
+    };
+
+    struct Enum
+    {
+        std::string_view typeName;
+        std::string_view name;
+        size_t size = 0;
+        bool isSigned = false;
+        uint32_t valueOffset = 0;
+        uint32_t valueCount = 0;
+        const EnumValue* values = nullptr;
+
+        // open addressing table of (value index + 1), 0 marks an empty slot, lookupSize is a power of two
+        uint32_t lookupOffset = 0;
+        uint32_t lookupSize = 0;
+        const uint32_t* lookup = nullptr;
+
+        bool contiguous = false; // values are first, first + 1, ... in declaration order
+
+        inline constexpr std::span<const EnumValue> Values() const
+        {
+            return std::span<const EnumValue>(values + valueOffset, valueCount);
+        }
+
+        inline constexpr const EnumValue* Find(std::string_view valueName) const
+        {
+            const uint64_t hash = HashName(valueName);
+            const uint32_t* table = lookup + lookupOffset;
+
+            for (uint32_t i = 0; i < lookupSize; i++)
+            {
+                uint32_t slot = table[(hash + i) & (lookupSize - 1)];
+                if (slot == 0)
+                    return nullptr;
+
+                const EnumValue& v = values[valueOffset + slot - 1];
+                if (v.hash == hash && v.name == valueName)
+                    return &v;
+            }
+
+            return nullptr;
+        }
+
+        inline constexpr bool FromString(std::string_view valueName, int64_t& outValue) const
+        {
+            const EnumValue* v = Find(valueName);
+            if (!v)
+                return false;
+
+            outValue = v->value;
+            return true;
+        }
+
+        inline constexpr std::string_view ToString(int64_t value) const
+        {
+            auto entries = Values();
+
+            if (contiguous)
+            {
+                if (entries.empty() || value < entries.front().value || value > entries.back().value)
+                    return {};
+
+                return entries[size_t(value - entries.front().value)].name;
+            }
+
+            for (const auto& v : entries)
+                if (v.value == value)
+                    return v.name;
+
+            return {};
+        }
+
+        // reads/writes an enum object of this type, 'data' usually comes from Field::Value<uint8_t>()
+        inline int64_t Read(const void* data) const
+        {
+            switch (size)
+            {
+            case 1: return isSigned ? int64_t(*(const int8_t*)data)  : int64_t(*(const uint8_t*)data);
+            case 2: return isSigned ? int64_t(*(const int16_t*)data) : int64_t(*(const uint16_t*)data);
+            case 4: return isSigned ? int64_t(*(const int32_t*)data) : int64_t(*(const uint32_t*)data);
+            case 8: return *(const int64_t*)data;
+            }
+
+            return 0;
+        }
+
+        inline void Write(void* data, int64_t value) const
+        {
+            switch (size)
+            {
+            case 1: *(uint8_t*)data  = (uint8_t)value;  break;
+            case 2: *(uint16_t*)data = (uint16_t)value; break;
+            case 4: *(uint32_t*)data = (uint32_t)value; break;
+            case 8: *(int64_t*)data  = value;           break;
+            }
+        }
+    };
+
+    struct Param
+    {
+        std::string_view typeName;
+        std::string_view name;
+        size_t size = 0;
+    };
+
+    // generated per FUNCTION(), calls the member directly.
+    // args[i] points to an object of the i-th parameter type, ret is either null (result discarded) or uninitialized storage of
+    // Method::returnSize bytes that the result is constructed into, a reference result is written as a pointer
+    using InvokeThunk = void(*)(void* object, void* const* args, void* ret);
+
+    struct Method
+    {
+        std::string_view name;
+        std::string_view returnTypeName;
+        size_t returnSize = 0; // 0 for void
+        bool isStatic = false;
+        bool isConst = false;
+        uint32_t paramOffset = 0;
+        uint8_t paramCount = 0;
+        Param* params = nullptr;
+        uint32_t attributesOffset = 0;
+        uint8_t attributesCount = 0;
+        Attribute* attributes = nullptr;
+        InvokeThunk thunk = nullptr;
+
+        inline const std::span<const Param> Params() const
+        {
+            Param* ptr = params + paramOffset;
+            return std::span<Param>(ptr, paramCount);
+        }
+
+        inline const std::span<const Attribute> Attributes() const
+        {
+            Attribute* ptr = attributes + attributesOffset;
+            return std::span<Attribute>(ptr, attributesCount);
+        }
+
+        inline void Invoke(void* object, void* const* args, void* ret = nullptr) const
+        {
+            thunk(object, args, ret);
+        }
+
+        // the argument types must be exactly the reflected parameter types, nothing is converted
+        template<typename ReturnType = void, typename Object, typename... Args>
+        inline ReturnType Call(Object& object, Args&&... args) const
+        {
+            void* argv[] = { const_cast<void*>(static_cast<const void*>(&args))..., nullptr };
+
+            if constexpr (std::is_void_v<ReturnType>)
+            {
+                thunk((void*)&object, argv, nullptr);
+            }
+            else if constexpr (std::is_reference_v<ReturnType>)
+            {
+                std::remove_reference_t<ReturnType>* result = nullptr;
+                thunk((void*)&object, argv, &result);
+                return static_cast<ReturnType>(*result);
+            }
+            else
+            {
+                alignas(ReturnType) uint8_t storage[sizeof(ReturnType)];
+                thunk((void*)&object, argv, storage);
+
+                ReturnType* result = std::launder(reinterpret_cast<ReturnType*>(storage));
+                ReturnType value = std::move(*result);
+                result->~ReturnType();
+                return value;
+            }
+        }
+    };
+
+    struct Base
+    {
+        uint32_t typeIndex = 0;
+        size_t offset = 0; // offset of the base subobject inside the derived type
+    };
+
+    // Used by the generated registries, the layout of base subobjects is left to the compiler instead of being guessed by the Meta tool.
+    template<typename DerivedType, typename BaseType>
+    inline size_t BaseOffset()
+    {
+        constexpr uintptr_t address = 0x1000; // any non-null address, static_cast maps null to null
+        return reinterpret_cast<uintptr_t>(static_cast<BaseType*>(reinterpret_cast<DerivedType*>(address))) - address;
+    }
+
+    // Fields() of a derived type already contains the fields of its reflected bases, with their offsets adjusted.
     struct Type
     {
         std::string_view typeName;
         std::string_view name;
         size_t size;
         uint32_t fieldOffset;
-        uint8_t fieldCount;
+        uint32_t fieldCount; // inherited fields included
         Field* fields = nullptr;
 
+        // leaf fields of this type and all nested types, with offsets relative to this type
+        uint32_t flatFieldOffset = 0;
+        uint32_t flatFieldCount = 0;
+        Field* flatFields = nullptr;
+
+        Type* types = nullptr;
+
+        uint32_t baseOffset = 0;
+        uint8_t baseCount = 0;
+        Base* bases = nullptr;
+
+        const Enum* enums = nullptr;
+
+        uint32_t methodOffset = 0;
+        uint8_t methodCount = 0;
+        Method* methods = nullptr;
+
         inline const std::span<const Field> Fields() const
         { 
             Field* ptr = fields + fieldOffset;
             return std::span<Field>(ptr, fieldCount);
         }
+
+        inline const std::span<const Field> FlatFields() const
+        {
+            Field* ptr = flatFields + flatFieldOffset;
+            return std::span<Field>(ptr, flatFieldCount);
+        }
+
+        inline const Type* ChildType(const Field& field) const
+        {
+            if (field.type != FieldType::Struct || !types)
+                return nullptr;
+
+            return &types[field.typeIndex];
+        }
+
+        inline const std::span<const Base> Bases() const
+        {
+            Base* ptr = bases + baseOffset;
+            return std::span<Base>(ptr, baseCount);
+        }
+
+        inline const Type* BaseType(const Base& base) const
+        {
+            return types ? &types[base.typeIndex] : nullptr;
+        }
+
+        inline const Enum* ChildEnum(const Field& field) const
+        {
+            if (field.type != FieldType::Enum || !enums)
+                return nullptr;
+
+            return &enums[field.typeIndex];
+        }
+
+        // declared methods only, inherited ones are found through Bases()
+        inline const std::span<const Method> Methods() const
+        {
+            Method* ptr = methods + methodOffset;
+            return std::span<Method>(ptr, methodCount);
+        }
+
+        inline const Method* FindMethod(const std::string_view& methodName) const
+        {
+            for (const auto& method : Methods())
+                if (method.name == methodName)
+                    return &method;
+
+            return nullptr;
+        }
     };
 
     struct TypeRegistry
@@ -1660,6 +3005,18 @@ namespace Meta {
         Field* fields;
         uint32_t fieldCount = 0;
 
+        Field* flatFields;
+        uint32_t flatFieldCount = 0;
+
+        Base* bases;
+        uint32_t baseCount = 0;
+
+        const Enum* enums;
+        uint32_t enumCount = 0;
+
+        Method* methods;
+        uint32_t methodCount = 0;
+
         inline const Type* GetType(const std::string_view& typeName) const
         {
             for (uint32_t i = 0; i < typeCount; i++)
@@ -1676,5 +3033,14 @@ namespace Meta {
 
             return nullptr;
         }
+
+        inline const Enum* GetEnum(const std::string_view& typeName) const
+        {
+            for (uint32_t i = 0; i < enumCount; i++)
+                if (typeName == enums[i].typeName)
+                    return &enums[i];
+
+            return nullptr;
+        }
     };
 }
@@ -1,7 +1,60 @@
 #pragma once
 
+#ifdef CORE_TRACK_ALLOCATIONS
+#include <new>
+
+// Replaces the global allocation functions of the executable so every allocation is attributed to the innermost
+// built-in profiler scope of the thread. On Windows each module keeps its own operator new, only the executable
+// allocations are seen. Aligned new is left to the default implementation.
+
+void* operator new(std::size_t size)
+{
+    void* p = std::malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+
+    BUILTIN_PROFILE_ALLOC(size);
+    CORE_PROFILE_ALLOC(p, size);
+    return p;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    void* p = std::malloc(size ? size : 1);
+    if (p)
+    {
+        BUILTIN_PROFILE_ALLOC(size);
+        CORE_PROFILE_ALLOC(p, size);
+    }
+    return p;
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept { return operator new(size, tag); }
+
+void operator delete(void* p) noexcept
+{
+    if (!p)
+        return;
+
+    BUILTIN_PROFILE_FREE();
+    CORE_PROFILE_FREE(p);
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept { operator delete(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { operator delete(p); }
+void operator delete[](void* p) noexcept { operator delete(p); }
+void operator delete[](void* p, std::size_t) noexcept { operator delete(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { operator delete(p); }
+#endif
+
 int Core::Main(int argc, char** argv)
 {
+#ifdef CORE_TRACK_ALLOCATIONS
+    Profiler::SetTrackingAllocations(true);
+#endif
+
     while (Application::IsApplicationRunning())
     {
         auto app = Application::CreateApplication({ argv, argc });
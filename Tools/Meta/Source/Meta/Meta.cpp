@@ -10,9 +10,32 @@
 #include <array>
 #include <chrono>
 #include <set>
+#include <algorithm>
+#include <cstring>
 
 #include <clang-c/Index.h>
 
+#if defined(_WIN32)
+#	define WIN32_LEAN_AND_MEAN
+#	define NOMINMAX
+#	include <winsock2.h>
+#	include <afunix.h>
+	using Socket = SOCKET;
+	constexpr Socket c_InvalidSocket = INVALID_SOCKET;
+	constexpr int c_SendFlags = 0;
+#else
+#	include <sys/socket.h>
+#	include <sys/un.h>
+#	include <unistd.h>
+	using Socket = int;
+	constexpr Socket c_InvalidSocket = -1;
+#	if defined(MSG_NOSIGNAL)
+	constexpr int c_SendFlags = MSG_NOSIGNAL; // a client that went away must not kill the server with SIGPIPE
+#	else
+	constexpr int c_SendFlags = 0;
+#	endif
+#endif
+
 //#define ONLY_PRINT_AST
 
 constexpr const char* c_LINE = "{:<30} {:<30} {:<30} {:<30} {:<10} {:<10} {:<15} {:<15} {:<5}";
@@ -24,16 +47,51 @@ namespace TempletText {
 // AUTO GENERATED
 ////////////////////////////////////////////
 INCLUDES
-
+THUNKS
 static Meta::Attribute s_Attributes[] = { 
 	Meta::Attribute(), 
 ATTRIBUTES 
 };
 
+static constexpr Meta::EnumValue s_EnumValues[] = { 
+
+ENUM_VALUES 
+};
+
+static constexpr uint32_t s_EnumLookup[] = { 
+
+ENUM_LOOKUP 
+};
+
+static constexpr Meta::Enum s_Enums[] = { 
+
+ENUMS 
+};
+
 static Meta::Field s_Fields[] = { 
 
 FIELDS 
 };
+
+static Meta::Field s_FlatFields[] = { 
+
+FLAT_FIELDS 
+};
+
+static Meta::Base s_Bases[] = { 
+
+BASES 
+};
+
+static Meta::Param s_Params[] = { 
+
+PARAMS 
+};
+
+static Meta::Method s_Methods[] = { 
+
+METHODS 
+};
 	
 static Meta::Type s_Types[] = {
 
@@ -43,7 +101,11 @@ TYPES
 static Meta::TypeRegistry s_Registry{ 
 	s_Types     , std::size(s_Types), 
 	s_Attributes, std::size(s_Attributes),
-	s_Fields    , std::size(s_Fields) 
+	s_Fields    , std::size(s_Fields),
+	s_FlatFields, std::size(s_FlatFields),
+	s_Bases     , std::size(s_Bases),
+	s_Enums     , std::size(s_Enums),
+	s_Methods   , std::size(s_Methods)
 };
 
 const Meta::TypeRegistry& Meta::NAME_SPACE::Registry() 
@@ -52,8 +114,48 @@ const Meta::TypeRegistry& Meta::NAME_SPACE::Registry()
 }
 )";
 
-	const char* c_TypeText = R"(    { "TYPE_NAME", "NAME", SIZE, FIELD_OFFSET, FIELD_COUNT, s_Fields })";
-	const char* c_FieldText = R"(    { "TYPE_NAME", "NAME", FIELD_TYPE, SIZE, OFFSET, ATTRIBUTE_OFFSET, ATTRIBUTE_COUNT, s_Attributes })";
+	const char* c_TypeText = R"(    { "TYPE_NAME", "NAME", SIZE, FIELD_OFFSET, FIELD_COUNT, s_Fields, FLAT_OFFSET, FLAT_COUNT, s_FlatFields, s_Types, BASE_OFFSET, BASE_COUNT, s_Bases, s_Enums, METHOD_OFFSET, METHOD_COUNT, s_Methods })";
+	const char* c_FieldText = R"(    { "TYPE_NAME", "NAME", FIELD_TYPE, SIZE, OFFSET, ATTRIBUTE_OFFSET, ATTRIBUTE_COUNT, s_Attributes, TYPE_INDEX })";
+	const char* c_BaseText = R"(    { TYPE_INDEX, OFFSET })";
+	const char* c_EnumText = R"(    { "TYPE_NAME", "NAME", SIZE, IS_SIGNED, VALUE_OFFSET, VALUE_COUNT, s_EnumValues, LOOKUP_OFFSET, LOOKUP_SIZE, s_EnumLookup, CONTIGUOUS })";
+	const char* c_EnumValueText = R"(    { "NAME", VALUE, HASH })";
+	const char* c_MethodText = R"(    { "NAME", "RETURN_TYPE", RETURN_SIZE, IS_STATIC, IS_CONST, PARAM_OFFSET, PARAM_COUNT, s_Params, ATTRIBUTE_OFFSET, ATTRIBUTE_COUNT, s_Attributes, THUNK })";
+	const char* c_ParamText = R"(    { "TYPE_NAME", "NAME", SIZE })";
+	const char* c_ThunkText = R"(static void THUNK(void* object, void* const* args, void* ret)
+{
+BODY}
+)";
+}
+
+// Substitutes the placeholders of a TempletText template in one pass. Placeholders are matched as whole identifiers and the substituted
+// text is never scanned again, so type, field and enumerator names that spell a placeholder are copied as they are.
+std::string FillTemplate(std::string_view text, std::initializer_list<std::pair<std::string_view, std::string_view>> values)
+{
+	auto IsIdentifier = [](char c) { return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_'; };
+
+	std::string result;
+	result.reserve(text.size());
+
+	for (size_t i = 0; i < text.size();)
+	{
+		if (!IsIdentifier(text[i]))
+		{
+			result += text[i++];
+			continue;
+		}
+
+		size_t end = i;
+		while (end < text.size() && IsIdentifier(text[end]))
+			end++;
+
+		const std::string_view token = text.substr(i, end - i);
+		auto value = std::find_if(values.begin(), values.end(), [token](const auto& value) { return value.first == token; });
+		result += value != values.end() ? value->second : token;
+
+		i = end;
+	}
+
+	return result;
 }
 
 static std::unordered_map<std::filesystem::path, bool> s_Headers;
@@ -61,6 +163,7 @@ constexpr uint8_t c_AttrKeyLength = 9;
 const std::set<std::string_view> c_TargetAttributes = {
 	"TYPE____ ",
 	"PROPERTY ",
+	"FUNCTION ",
 };
 
 struct Timer
@@ -116,31 +219,98 @@ enum class FieldType
 	Bool, Bool2, Bool3, Bool4,
 
 	Uint8, Uint16, Uint64,
-	Int8, Int16, Int64
+	Int8, Int16, Int64,
+
+	Struct,
+	Enum
 };
 
 struct Field
 {
 	std::string typeName;
+	std::string canonicalTypeName; // nested reflected types and enums are matched on it, the written spelling may be unqualified
 	std::string name;
 	size_t size = 0;
 	size_t offset = 0;
+	std::string baseOffsets; // Meta::BaseOffset() terms added to 'offset' for fields inherited from a base type
 	size_t typeIndex = 0;
+	size_t childTypeIndex = 0;
+	bool isNamedType = false; // a class, struct, union or enum, which only make sense as Struct or Enum fields
 	uint32_t attributesOffset = 0;
 	uint8_t attributesCount = 0;
 	AccessSpecifier accessSpecifier;
 	FieldType type;
 };
 
+struct BaseType
+{
+	std::string typeName; // canonical spelling
+	std::string offset;   // computed by the generated code, libclang has no portable query for base offsets
+	size_t typeIndex = 0;
+	bool isReflected = false;
+};
+
+struct Param
+{
+	std::string typeName;
+	std::string canonicalTypeName; // spelled in the generated thunks, it does not depend on the scope of the declaration
+	std::string name;
+	size_t size = 0;
+	bool isRValueReference = false;
+};
+
+struct Method
+{
+	std::string name;
+	std::string returnTypeName;
+	std::string canonicalReturnTypeName;
+	size_t returnSize = 0;
+	bool returnsReference = false;
+	bool isStatic = false;
+	bool isConst = false;
+	std::vector<Param> params;
+	uint32_t attributesOffset = 0;
+	uint8_t attributesCount = 0;
+};
+
 struct Type
 {
 	std::string typeName;
 	std::string name;
 	std::string parents;
 	size_t size = 0;
+	std::vector<BaseType> bases;
 	std::vector<Field> fields;
+	std::vector<Method> methods;
+};
+
+struct EnumValue
+{
+	std::string name;
+	int64_t value = 0;
+};
+
+struct Enum
+{
+	std::string typeName;
+	std::string name;
+	size_t size = 0;
+	bool isSigned = false;
+	std::vector<EnumValue> values;
 };
 
+// must match Meta::HashName() in Core.h
+constexpr uint64_t HashName(std::string_view name)
+{
+	uint64_t hash = 14695981039346656037ull;
+	for (char c : name)
+	{
+		hash ^= (uint8_t)c;
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
 const char* ToStrinig(AccessSpecifier accessSpecifier)
 {
 	switch (accessSpecifier)
@@ -182,6 +352,8 @@ constexpr const char* ToString(FieldType type)
 	case FieldType::Int8:   return "Meta::FieldType::Int8";
 	case FieldType::Int16:  return "Meta::FieldType::Int16";
 	case FieldType::Int64:  return "Meta::FieldType::Int64";
+	case FieldType::Struct: return "Meta::FieldType::Struct";
+	case FieldType::Enum:   return "Meta::FieldType::Enum";
 	}
 
 	return "Unknown";
@@ -211,11 +383,20 @@ struct TypeRegistry
 
 	uint32_t typesCount = 0;
 
+	std::vector<Enum> enums;
+	std::map<std::string, uint32_t> enumsMap;
+
 	void AddType(const Type& type)
 	{
 		types.emplace_back(type);
 		typesMap[type.typeName] = typesCount++;
 	}
+
+	void AddEnum(const Enum& e)
+	{
+		enumsMap[e.typeName] = (uint32_t)enums.size();
+		enums.emplace_back(e);
+	}
 };
 
 struct VisitorData
@@ -243,6 +424,205 @@ std::vector<std::filesystem::path> FindFilesInDirectory(
 	return filesPaths;
 }
 
+// Points fields at the nested reflected types and enums they hold. Runs after the whole translation unit is visited, so the
+// order in which types are declared or included does not matter. Named types that are still unresolved are not reflected.
+void ResolveFieldTypes(TypeRegistry& registry)
+{
+	for (auto& type : registry.types)
+	{
+		for (auto& field : type.fields)
+		{
+			auto childType = registry.typesMap.find(field.canonicalTypeName);
+			auto childEnum = registry.enumsMap.find(field.canonicalTypeName);
+
+			if (childType != registry.typesMap.end())
+			{
+				field.type = FieldType::Struct;
+				field.childTypeIndex = childType->second;
+			}
+			else if (childEnum != registry.enumsMap.end())
+			{
+				field.type = FieldType::Enum;
+				field.childTypeIndex = childEnum->second;
+			}
+			else if (field.isNamedType && field.type == FieldType::None)
+			{
+				printf("[HeaderTool] : %s::%s has the unreflected type %s, left unresolved\n",
+					type.typeName.c_str(), field.name.c_str(), field.canonicalTypeName.c_str());
+			}
+		}
+	}
+}
+
+// Prepends the fields of reflected base types with their offsets adjusted to the derived type.
+// A base has to be complete where it is derived from, so it is always registered (and merged) before its derived types.
+void MergeBaseFields(TypeRegistry& registry)
+{
+	for (auto& type : registry.types)
+	{
+		std::vector<Field> mergedFields;
+
+		for (auto& base : type.bases)
+		{
+			auto it = registry.typesMap.find(base.typeName);
+			if (it == registry.typesMap.end())
+				continue;
+
+			base.typeIndex = it->second;
+			base.isReflected = true;
+			base.offset = std::format("Meta::BaseOffset<{}, {}>()", type.typeName, base.typeName);
+
+			for (const auto& field : registry.types[base.typeIndex].fields)
+			{
+				Field& merged = mergedFields.emplace_back(field);
+				merged.baseOffsets = field.baseOffsets.empty() ? base.offset : base.offset + " + " + field.baseOffsets;
+			}
+		}
+
+		if (mergedFields.empty())
+			continue;
+
+		mergedFields.insert(mergedFields.end(), type.fields.begin(), type.fields.end());
+		type.fields = std::move(mergedFields);
+	}
+}
+
+// Collects the leaf fields of 'type', descending into nested reflected types, with offsets relative to the outermost type.
+void FlattenFields(
+	const TypeRegistry& registry, 
+	const Type& type, 
+	size_t baseOffset, 
+	const std::string& baseOffsets, 
+	const std::string& prefix, 
+	std::vector<Field>& outFields
+)
+{
+	for (const auto& field : type.fields)
+	{
+		std::string offsets = baseOffsets.empty() || field.baseOffsets.empty() ? baseOffsets + field.baseOffsets : baseOffsets + " + " + field.baseOffsets;
+
+		if (field.type == FieldType::Struct)
+		{
+			FlattenFields(registry, registry.types[field.childTypeIndex], baseOffset + field.offset, offsets, prefix + field.name + ".", outFields);
+			continue;
+		}
+
+		Field& leaf = outFields.emplace_back(field);
+		leaf.name = prefix + field.name;
+		leaf.offset = baseOffset + field.offset;
+		leaf.baseOffsets = std::move(offsets);
+	}
+}
+
+// Emits the value table of every enum and an open addressing (linear probing) table of value indices keyed by HashName(),
+// sized to the next power of two of twice the value count so Meta::Enum::Find() stays close to one probe.
+void GenerateEnums(
+	const TypeRegistry& registry,
+	std::string& outValuesText,
+	std::string& outLookupText,
+	std::string& outEnumsText
+)
+{
+	size_t valueCount = 0;
+	size_t lookupCount = 0;
+
+	for (const auto& e : registry.enums)
+	{
+		uint32_t lookupSize = 0;
+		if (!e.values.empty())
+		{
+			lookupSize = 1;
+			while (lookupSize < e.values.size() * 2)
+				lookupSize <<= 1;
+		}
+
+		std::vector<uint32_t> lookup(lookupSize, 0);
+		bool contiguous = true;
+
+		for (size_t i = 0; i < e.values.size(); i++)
+		{
+			const auto& value = e.values[i];
+			const uint64_t hash = HashName(value.name);
+
+			uint64_t slot = hash & (lookupSize - 1);
+			while (lookup[slot] != 0)
+				slot = (slot + 1) & (lookupSize - 1);
+			lookup[slot] = uint32_t(i + 1);
+
+			if (value.value != e.values[0].value + int64_t(i))
+				contiguous = false;
+
+			std::string temp = FillTemplate(TempletText::c_EnumValueText, {
+				{ "NAME", value.name },
+				{ "VALUE", value.value == INT64_MIN ? "INT64_MIN" : std::to_string(value.value) },
+				{ "HASH", std::format("0x{:016x}ull", hash) },
+			});
+
+			outValuesText += outValuesText.empty() ? temp : ",\n" + temp;
+		}
+
+		for (uint32_t slot : lookup)
+		{
+			std::string temp = "    " + std::to_string(slot);
+			outLookupText += outLookupText.empty() ? temp : ",\n" + temp;
+		}
+
+		std::string temp = FillTemplate(TempletText::c_EnumText, {
+			{ "TYPE_NAME", e.typeName },
+			{ "NAME", e.name },
+			{ "SIZE", std::to_string(e.size) },
+			{ "IS_SIGNED", e.isSigned ? "true" : "false" },
+			{ "VALUE_OFFSET", std::to_string(valueCount) },
+			{ "VALUE_COUNT", std::to_string(e.values.size()) },
+			{ "LOOKUP_OFFSET", std::to_string(lookupCount) },
+			{ "LOOKUP_SIZE", std::to_string(lookupSize) },
+			{ "CONTIGUOUS", contiguous ? "true" : "false" },
+		});
+
+		outEnumsText += outEnumsText.empty() ? temp : ",\n" + temp;
+
+		valueCount += e.values.size();
+		lookupCount += lookupSize;
+	}
+}
+
+std::string GenerateThunk(const Type& type, const Method& method, const std::string& thunkName)
+{
+	std::string args;
+	for (size_t i = 0; i < method.params.size(); i++)
+	{
+		const auto& param = method.params[i];
+
+		std::string arg = std::format("*static_cast<std::remove_cvref_t<{}>*>(args[{}])", param.canonicalTypeName, i);
+		if (param.isRValueReference)
+			arg = "std::move(" + arg + ")";
+
+		args += i == 0 ? arg : ", " + arg;
+	}
+
+	std::string body;
+	std::string call;
+
+	if (method.isStatic)
+	{
+		call = std::format("{}::{}({})", type.typeName, method.name, args);
+	}
+	else
+	{
+		body += std::format("    auto& self = *static_cast<{}{}*>(object);\n", method.isConst ? "const " : "", type.typeName);
+		call = std::format("self.{}({})", method.name, args);
+	}
+
+	if (method.returnSize == 0)
+		body += std::format("    {};\n", call);
+	else if (method.returnsReference)
+		body += std::format("    if (ret) *static_cast<std::remove_reference_t<{}>**>(ret) = &{};\n    else {};\n", method.canonicalReturnTypeName, call, call);
+	else
+		body += std::format("    if (ret) new (ret) std::remove_cv_t<{}>({});\n    else {};\n", method.canonicalReturnTypeName, call, call);
+
+	return FillTemplate(TempletText::c_ThunkText, { { "THUNK", thunkName }, { "BODY", body } });
+}
+
 void GenerateCppFileMetaData(
 	const std::string& includesText, 
 	const TypeRegistry& registry, 
@@ -265,16 +645,17 @@ void GenerateCppFileMetaData(
 		for (size_t i = 0; i < fields.size(); ++i)
 		{
 			const auto& field = fields[i];
-			std::string temp = TempletText::c_FieldText;
-			temp.replace(temp.find("TYPE_NAME"), 9, field.typeName);
-			temp.replace(temp.find("NAME"), 4, field.name);
-			temp.replace(temp.find("FIELD_TYPE"), 10, ToString(field.type));
-			temp.replace(temp.find("SIZE"), 4, std::to_string(field.size));
-			temp.replace(temp.find("OFFSET"), 6, std::to_string(field.offset));
-			//temp.replace(temp.find("TYPE_INDEX"), 10, std::to_string(field.typeIndex));
-			temp.replace(temp.find("ATTRIBUTE_OFFSET"), 16, std::to_string(field.attributesOffset));
-			temp.replace(temp.find("ATTRIBUTE_COUNT"), 15, std::to_string(field.attributesCount));
-			//temp.replace(temp.find("ACCESS_SPECIFIER"), 16, ToStrinig(field.AccessSpecifier));
+			std::string temp = FillTemplate(TempletText::c_FieldText, {
+				{ "TYPE_NAME", field.typeName },
+				{ "NAME", field.name },
+				{ "FIELD_TYPE", ToString(field.type) },
+				{ "SIZE", std::to_string(field.size) },
+				{ "OFFSET", field.baseOffsets.empty() ? std::to_string(field.offset) : field.baseOffsets + " + " + std::to_string(field.offset) },
+				{ "ATTRIBUTE_OFFSET", std::to_string(field.attributesOffset) },
+				{ "ATTRIBUTE_COUNT", std::to_string(field.attributesCount) },
+				{ "TYPE_INDEX", std::to_string(field.childTypeIndex) },
+				//{ "ACCESS_SPECIFIER", ToStrinig(field.AccessSpecifier) },
+			});
 			
 			fieldText += temp;
 			if (i < fields.size() - 1)
@@ -286,36 +667,127 @@ void GenerateCppFileMetaData(
 	// Generate types
 	std::string typesText;
 	std::string feildsText;
+	std::string flatFieldsText;
+	std::string basesText;
+	std::string methodsText;
+	std::string paramsText;
+	std::string thunksText;
 	size_t fieldCount = 0;
+	size_t flatFieldCount = 0;
+	size_t baseCount = 0;
+	size_t methodCount = 0;
+	size_t paramCount = 0;
 	for (size_t i = 0; i < registry.types.size(); ++i)
 	{
 		const auto& type = registry.types[i];
-		std::string temp = TempletText::c_TypeText;
-		temp.replace(temp.find("TYPE_NAME"), 9, type.typeName);
-		temp.replace(temp.find("NAME"), 4, type.name);
-		//temp.replace(temp.find("BASE_CLASSES"), 12, type.parents);
-		temp.replace(temp.find("SIZE"), 4, std::to_string(type.size));
-		temp.replace(temp.find("FIELD_OFFSET"), 12, std::to_string(fieldCount));
-		temp.replace(temp.find("FIELD_COUNT"), 11, std::to_string(type.fields.size()));
+
+		std::vector<Field> flatFields;
+		FlattenFields(registry, type, 0, "", "", flatFields);
+
+		size_t reflectedBaseCount = 0;
+		for (const auto& base : type.bases)
+		{
+			if (!base.isReflected)
+				continue;
+
+			std::string temp = FillTemplate(TempletText::c_BaseText, { { "TYPE_INDEX", std::to_string(base.typeIndex) }, { "OFFSET", base.offset } });
+
+			basesText += basesText.empty() ? temp : ",\n" + temp;
+			reflectedBaseCount++;
+		}
+
+		for (const auto& method : type.methods)
+		{
+			for (const auto& param : method.params)
+			{
+				std::string temp = FillTemplate(TempletText::c_ParamText, {
+					{ "TYPE_NAME", param.typeName },
+					{ "NAME", param.name },
+					{ "SIZE", std::to_string(param.size) },
+				});
+
+				paramsText += paramsText.empty() ? temp : ",\n" + temp;
+			}
+
+			const std::string thunkName = "s_Invoke" + std::to_string(methodCount);
+			thunksText += "\n" + GenerateThunk(type, method, thunkName);
+
+			std::string temp = FillTemplate(TempletText::c_MethodText, {
+				{ "NAME", method.name },
+				{ "RETURN_TYPE", method.returnTypeName },
+				{ "RETURN_SIZE", std::to_string(method.returnSize) },
+				{ "IS_STATIC", method.isStatic ? "true" : "false" },
+				{ "IS_CONST", method.isConst ? "true" : "false" },
+				{ "PARAM_OFFSET", std::to_string(paramCount) },
+				{ "PARAM_COUNT", std::to_string(method.params.size()) },
+				{ "ATTRIBUTE_OFFSET", std::to_string(method.attributesOffset) },
+				{ "ATTRIBUTE_COUNT", std::to_string(method.attributesCount) },
+				{ "THUNK", thunkName },
+			});
+
+			methodsText += methodsText.empty() ? temp : ",\n" + temp;
+
+			paramCount += method.params.size();
+			methodCount++;
+		}
+
+		std::string temp = FillTemplate(TempletText::c_TypeText, {
+			{ "TYPE_NAME", type.typeName },
+			{ "NAME", type.name },
+			//{ "BASE_CLASSES", type.parents },
+			{ "SIZE", std::to_string(type.size) },
+			{ "FIELD_OFFSET", std::to_string(fieldCount) },
+			{ "FIELD_COUNT", std::to_string(type.fields.size()) },
+			{ "FLAT_OFFSET", std::to_string(flatFieldCount) },
+			{ "FLAT_COUNT", std::to_string(flatFields.size()) },
+			{ "BASE_OFFSET", std::to_string(baseCount) },
+			{ "BASE_COUNT", std::to_string(reflectedBaseCount) },
+			{ "METHOD_OFFSET", std::to_string(methodCount - type.methods.size()) },
+			{ "METHOD_COUNT", std::to_string(type.methods.size()) },
+		});
+
+		baseCount += reflectedBaseCount;
 
 		fieldCount += type.fields.size();
 		feildsText += GenerateFields(type.fields);
 
+		flatFieldCount += flatFields.size();
+		flatFieldsText += GenerateFields(flatFields);
+
 		typesText += temp;
 		if (i < registry.types.size() - 1)
 		{
 			typesText += ",\n";
-			feildsText += ",\n";
+
+			if (!type.fields.empty())
+				feildsText += ",\n";
+
+			if (!flatFields.empty())
+				flatFieldsText += ",\n";
 		}
 	}
 
+	std::string enumValuesText;
+	std::string enumLookupText;
+	std::string enumsText;
+	GenerateEnums(registry, enumValuesText, enumLookupText, enumsText);
+
 	// Generate final output
-	std::string finalText = TempletText::c_TypeArrrayText;
-	finalText.replace(finalText.find("INCLUDES"), 8, includesText);
-	finalText.replace(finalText.find("TYPES"), 5, typesText.empty() ? "    {}" : typesText);
-	finalText.replace(finalText.find("FIELDS"), 6, feildsText.empty() ? "    {}" : feildsText);
-	finalText.replace(finalText.find("ATTRIBUTES"), 10, registry.attributes);
-	finalText.replace(finalText.find("NAME_SPACE"), 10, nameSpace);
+	std::string finalText = FillTemplate(TempletText::c_TypeArrrayText, {
+		{ "INCLUDES", includesText },
+		{ "THUNKS", thunksText },
+		{ "ATTRIBUTES", registry.attributes },
+		{ "ENUM_VALUES", enumValuesText.empty() ? "    {}" : enumValuesText },
+		{ "ENUM_LOOKUP", enumLookupText.empty() ? "    0" : enumLookupText },
+		{ "ENUMS", enumsText.empty() ? "    {}" : enumsText },
+		{ "FIELDS", feildsText.empty() ? "    {}" : feildsText },
+		{ "FLAT_FIELDS", flatFieldsText.empty() ? "    {}" : flatFieldsText },
+		{ "BASES", basesText.empty() ? "    {}" : basesText },
+		{ "PARAMS", paramsText.empty() ? "    {}" : paramsText },
+		{ "METHODS", methodsText.empty() ? "    {}" : methodsText },
+		{ "TYPES", typesText.empty() ? "    {}" : typesText },
+		{ "NAME_SPACE", nameSpace },
+	});
 	
 	outFile << finalText;
 	outFile.close();
@@ -468,6 +940,139 @@ std::string GetBaseClasses(CXCursor cursor)
 	return clientData.baseClasses;
 }
 
+// Offsets of the bases are left to the generated code (Meta::BaseOffset), only bases it can static_cast to are kept.
+std::vector<BaseType> GetBaseTypes(CXCursor cursor)
+{
+	std::vector<BaseType> bases;
+
+	clang_visitChildren(
+		cursor,
+		[](CXCursor c, CXCursor parent, CXClientData clientData)
+		{
+			if (clang_getCursorKind(c) != CXCursor_CXXBaseSpecifier)
+				return CXChildVisit_Continue;
+
+			auto* bases = (std::vector<BaseType>*)clientData;
+
+			const CXString baseName = clang_getTypeSpelling(clang_getCanonicalType(clang_getCursorType(c)));
+			BaseType& base = bases->emplace_back();
+			base.typeName = clang_getCString(baseName);
+			clang_disposeString(baseName);
+
+			if (clang_isVirtualBase(c))
+			{
+				printf("[HeaderTool] : virtual base %s is not supported, its fields are skipped\n", base.typeName.c_str());
+				base.typeName.clear();
+			}
+			else if (clang_getCXXAccessSpecifier(c) != CX_CXXPublic)
+			{
+				printf("[HeaderTool] : base %s is not public, its fields are skipped\n", base.typeName.c_str());
+				base.typeName.clear();
+			}
+
+			return CXChildVisit_Continue;
+		},
+		&bases);
+
+	return bases;
+}
+
+void GetEnumValues(CXCursor cursor, Enum& e)
+{
+	clang_visitChildren(
+		cursor,
+		[](CXCursor c, CXCursor parent, CXClientData clientData)
+		{
+			if (clang_getCursorKind(c) != CXCursor_EnumConstantDecl)
+				return CXChildVisit_Continue;
+
+			Enum* e = (Enum*)clientData;
+
+			const CXString name = clang_getCursorSpelling(c);
+
+			EnumValue& value = e->values.emplace_back();
+			value.name = clang_getCString(name);
+			value.value = e->isSigned ? (int64_t)clang_getEnumConstantDeclValue(c) : (int64_t)clang_getEnumConstantDeclUnsignedValue(c);
+
+			clang_disposeString(name);
+
+			return CXChildVisit_Continue;
+		},
+		&e);
+}
+
+bool IsSignedIntegerType(CXType type)
+{
+	switch (clang_getCanonicalType(type).kind)
+	{
+	case CXType_Char_S:
+	case CXType_SChar:
+	case CXType_Short:
+	case CXType_Int:
+	case CXType_Long:
+	case CXType_LongLong:
+	case CXType_Int128:
+		return true;
+	default:break;
+	}
+
+	return false;
+}
+
+std::string GetTypeSpelling(CXType type)
+{
+	const CXString spelling = clang_getTypeSpelling(type);
+	std::string str = clang_getCString(spelling);
+	clang_disposeString(spelling);
+
+	return str;
+}
+
+Method GetMethod(CXCursor cursor)
+{
+	Method method;
+
+	const CXString name = clang_getCursorSpelling(cursor);
+	method.name = clang_getCString(name);
+	clang_disposeString(name);
+
+	const CXType resultType = clang_getCursorResultType(cursor);
+	method.returnTypeName = GetTypeSpelling(resultType);
+	method.canonicalReturnTypeName = GetTypeSpelling(clang_getCanonicalType(resultType));
+	method.returnsReference = resultType.kind == CXType_LValueReference || resultType.kind == CXType_RValueReference;
+	method.isStatic = clang_CXXMethod_isStatic(cursor);
+	method.isConst = clang_CXXMethod_isConst(cursor);
+
+	if (method.returnsReference)
+		method.returnSize = sizeof(void*);
+	else if (clang_getCanonicalType(resultType).kind != CXType_Void)
+		method.returnSize = clang_Type_getSizeOf(resultType);
+
+	const int argCount = clang_Cursor_getNumArguments(cursor);
+	for (int i = 0; i < argCount; i++)
+	{
+		const CXCursor arg = clang_Cursor_getArgument(cursor, i);
+		const CXType argType = clang_getCursorType(arg);
+		const CXString argName = clang_getCursorSpelling(arg);
+
+		Param& param = method.params.emplace_back();
+		param.typeName = GetTypeSpelling(argType);
+		param.canonicalTypeName = GetTypeSpelling(clang_getCanonicalType(argType));
+		param.name = clang_getCString(argName);
+		param.isRValueReference = argType.kind == CXType_RValueReference;
+
+		const bool isReference = argType.kind == CXType_LValueReference || param.isRValueReference;
+		param.size = clang_Type_getSizeOf(isReference ? clang_getPointeeType(argType) : argType);
+
+		if (param.name.empty())
+			param.name = "arg" + std::to_string(i);
+
+		clang_disposeString(argName);
+	}
+
+	return method;
+}
+
 std::filesystem::path GetCursorSourceFilePath(CXCursor cursor)
 {
 	CXSourceLocation location = clang_getCursorLocation(cursor);
@@ -568,6 +1173,23 @@ FieldType GetFieldType(std::string& typeName)
 	return fieldType;
 }
 
+// Appends the arguments of the current annotations to the attribute table, returns false if none has arguments.
+bool AddAttributes(VisitorData* data, uint8_t& outCount)
+{
+	outCount = 0;
+
+	for (int i = 0; i < data->currentAttributes.size(); i++)
+	{
+		if (data->currentAttributes[i].length() > c_AttrKeyLength)
+		{
+			data->registry->attributes += "    " + std::string(data->currentAttributes[i].substr(c_AttrKeyLength)) + ",\n";
+			outCount++;
+		}
+	}
+
+	return outCount > 0;
+}
+
 static CXChildVisitResult VisitTU(CXCursor currentCursor, CXCursor parent, CXClientData clientData)
 {
 	std::filesystem::path filePath = std::filesystem::absolute(GetCursorSourceFilePath(currentCursor)).lexically_normal();
@@ -607,6 +1229,7 @@ static CXChildVisitResult VisitTU(CXCursor currentCursor, CXCursor parent, CXCli
 					.name = displayNameStr,
 					.parents = baseClasses,
 					.size = size,
+					.bases = GetBaseTypes(currentCursor),
 				};
 
 				data->registry->AddType(t);
@@ -614,40 +1237,88 @@ static CXChildVisitResult VisitTU(CXCursor currentCursor, CXCursor parent, CXCli
 				PrintNode(data, "", displayName, kindSpelling, typeSpelling, baseClasses.c_str(), size, offset, isAttr, has_attr);
 			}
 		}
-		else if (clang_getCursorKind(currentCursor) == CXCursor_FieldDecl)
+		else if (clang_getCursorKind(currentCursor) == CXCursor_EnumDecl)
 		{
-			CX_CXXAccessSpecifier accessSpecifier = clang_getCXXAccessSpecifier(currentCursor);
+			if (data->currentAttributes[0].find("TYPE____") != std::string::npos)
+			{
+				Enum e = {
+					.typeName = typeSpellingStr,
+					.name = displayNameStr,
+					.size = size,
+					.isSigned = IsSignedIntegerType(clang_getEnumDeclIntegerType(currentCursor)),
+				};
 
-			uint8_t attributeCount = 0;
-			bool hasFieldAtt = false;
+				GetEnumValues(currentCursor, e);
 
-			for (int i = 0; i < data->currentAttributes.size(); i++)
-			{
-				if (data->currentAttributes[i].length() > c_AttrKeyLength)
-				{
-					data->registry->attributes += "    " + std::string(data->currentAttributes[i].substr(c_AttrKeyLength)) + ",\n";
-					attributeCount++;
+				data->registry->AddEnum(e);
 
-					hasFieldAtt = true;
-				}
+				PrintNode(data, "", displayName, kindSpelling, typeSpelling, "", size, offset, isAttr, has_attr);
 			}
-
+		}
+		else if (clang_getCursorKind(currentCursor) == CXCursor_CXXMethod)
+		{
 			auto parentName = clang_getCString(parentTypeSpelling);
-			auto& index = data->registry->typesMap.at(parentName);
+			auto index = data->registry->typesMap.find(parentName);
 
-			std::string typeName = typeSpellingStr;
-			FieldType fieldType = GetFieldType(typeName);
+			if (index == data->registry->typesMap.end())
+			{
+				printf("[HeaderTool] : %s::%s is not a member of a reflected type, skipped\n", parentName, displayNameStr);
+			}
+			else if (clang_getCXXAccessSpecifier(currentCursor) != CX_CXXPublic)
+			{
+				printf("[HeaderTool] : %s::%s is not public, the generated thunk can't call it, skipped\n", parentName, displayNameStr);
+			}
+			else if (clang_Cursor_isVariadic(currentCursor))
+			{
+				printf("[HeaderTool] : %s::%s is variadic, skipped\n", parentName, displayNameStr);
+			}
+			else
+			{
+				uint8_t attributeCount = 0;
+				bool hasAtt = AddAttributes(data, attributeCount);
 
-			Field field = {
-				.typeName = typeSpellingStr,
-				.name = displayNameStr,
+				Method method = GetMethod(currentCursor);
+				method.attributesOffset = hasAtt ? data->registry->attributCount : 0;
+				method.attributesCount = hasAtt ? attributeCount : (uint8_t)1;
+
+				PrintNode(data, "Public", displayName, kindSpelling, typeSpelling, "", size, 0, isAttr, has_attr);
+
+				data->registry->types[index->second].methods.push_back(method);
+				data->registry->attributCount += attributeCount;
+			}
+		}
+		else if (clang_getCursorKind(currentCursor) == CXCursor_FieldDecl)
+		{
+			CX_CXXAccessSpecifier accessSpecifier = clang_getCXXAccessSpecifier(currentCursor);
+
+			uint8_t attributeCount = 0;
+			bool hasFieldAtt = AddAttributes(data, attributeCount);
+
+			auto parentName = clang_getCString(parentTypeSpelling);
+			auto& index = data->registry->typesMap.at(parentName);
+
+			// nested reflected types and enums are resolved by ResolveFieldTypes once the whole translation unit is visited,
+			// the field's type may be declared after it
+			const CXType canonicalType = clang_getCanonicalType(cursorType);
+			const CXString canonicalSpelling = clang_getTypeSpelling(canonicalType);
+			std::string canonicalTypeName = clang_getCString(canonicalSpelling);
+			clang_disposeString(canonicalSpelling);
+
+			std::string typeName = typeSpellingStr;
+
+			Field field = {
+				.typeName = typeSpellingStr,
+				.canonicalTypeName = std::move(canonicalTypeName),
+				.name = displayNameStr,
 				.size = size,
 				.offset = offset,
 				.typeIndex = index,
+				.childTypeIndex = 0,
+				.isNamedType = canonicalType.kind == CXType_Record || canonicalType.kind == CXType_Enum,
 				.attributesOffset = hasFieldAtt ? data->registry->attributCount : 0,
 				.attributesCount = hasFieldAtt ? attributeCount : (uint8_t)1,
 				.accessSpecifier = (AccessSpecifier)accessSpecifier,
-				.type = fieldType
+				.type = GetFieldType(typeName)
 			};
 	
 			PrintNode(data, ToStrinig(accessSpecifier), displayName, kindSpelling, typeSpelling, baseClasses.c_str(), size, offset, isAttr, has_attr);
@@ -674,65 +1345,132 @@ static CXChildVisitResult VisitTU(CXCursor currentCursor, CXCursor parent, CXCli
 };
 #endif
 
-std::string GenerateParserInputFile(const std::filesystem::path& sourceDir, const std::filesystem::path& outputFile)
+// Writes the includes parsed by libclang to 'inputFile' and returns them relative to 'generatedFile', the two may be in different directories.
+std::string GenerateParserInputFile(const std::filesystem::path& sourceDir, const std::filesystem::path& inputFile, const std::filesystem::path& generatedFile)
 {
 	auto files = FindFilesInDirectory(sourceDir, ".h");
-	
-	std::ofstream outFile(outputFile);
-	if (!outFile.is_open())
-	{
-		std::cerr << "Error opening file for writing: " << outputFile << "\n";
-		return {};
-	}
+
+	auto IncludeFrom = [](const std::filesystem::path& file, const std::filesystem::path& from) {
+		std::filesystem::path path = std::filesystem::relative(file, from.parent_path()).lexically_normal();
+		if (path.empty()) // another drive
+			path = std::filesystem::absolute(file).lexically_normal();
+
+		return std::format("#include \"{}\"\n", path.string());
+	};
 
 	std::string includes;
+	std::string inputIncludes;
+	s_Headers.clear();
 
 	for (auto& file : files)
 	{
+		// without an intermediate directory the input file lives in the source directory, it must not include itself
+		std::error_code ec;
+		if (std::filesystem::equivalent(file, inputFile, ec))
+			continue;
+
 		auto f = file.string();
 		printf("header : %s \n", f.c_str());
-		auto strPath = std::filesystem::relative(file, std::filesystem::path(outputFile).parent_path()).lexically_normal().string();
-		includes += std::format("#include \"{}\"\n", strPath);
+		includes += IncludeFrom(file, generatedFile);
+		inputIncludes += IncludeFrom(file, inputFile);
 		s_Headers[file] = true;
 	}
 
-	outFile << includes;
+	// keep the file (and its time stamp) untouched when nothing changed, the server tracks it as a dependency of the parsed one
+	{
+		std::ifstream inFile(inputFile);
+		std::stringstream current;
+		current << inFile.rdbuf();
+
+		if (inFile.is_open() && current.str() == inputIncludes)
+			return includes;
+	}
+
+	std::ofstream outFile(inputFile);
+	if (!outFile.is_open())
+	{
+		std::cerr << "Error opening file for writing: " << inputFile << "\n";
+		return {};
+	}
+
+	outFile << inputIncludes;
 	outFile.close();
 
 	return includes;
 }
 
-int main(int argc, char* argv[])
+struct Options
 {
-	Timer totalTime;
+	std::filesystem::path sourceDir;
+	std::filesystem::path ouputFilePath;
+	std::string nameSpace;
+	std::vector<std::string> includeArgs;
+	std::filesystem::path inputDir; // -O<dir>, where the parser input file is written, the output directory by default
+};
+
+// returns false if the arguments don't describe a valid run, 'outLog' tells why
+bool ParseOptions(const std::vector<std::string>& args, Options& options, std::string& outLog)
+{
+	if (args.size() < 3)
+	{
+		outLog += "[HeaderTool] : usage : Meta <sourceDir> <ouputFile> <nameSpace> [-I<dir> ...] [-O<intermediateDir>]\n";
+		outLog += "                       Meta --server <socket>\n";
+		outLog += "                       Meta --client <socket> <sourceDir> <ouputFile> <nameSpace> [-I<dir> ...] [-O<intermediateDir>] | --shutdown\n";
+		return false;
+	}
 
-	const char* sourceDir = argv[1];
-	const char* ouputFilePathStr = argv[2];
-	const char* nameSpace = argv[3];
-	std::filesystem::path ouputFilePath = std::filesystem::path(ouputFilePathStr);
+	options.sourceDir = args[0];
+	options.ouputFilePath = args[1];
+	options.nameSpace = args[2];
 
-	if (!std::filesystem::exists(sourceDir))
+	for (size_t i = 3; i < args.size(); ++i)
 	{
-		printf("[HeaderTool] : sourceDir %s not exist\n", sourceDir);
-		return 0;
+		if (args[i].find("-I") == 0)
+			options.includeArgs.push_back(args[i]);
+		else if (args[i].find("-O") == 0)
+			options.inputDir = args[i].substr(2);
 	}
 
-	if (!std::filesystem::exists(ouputFilePath.parent_path()))
+	if (!std::filesystem::exists(options.sourceDir))
 	{
-		std::string str = ouputFilePath.parent_path().string();
-		printf("[HeaderTool] : ouput directory %s not exist\n", str.c_str());
-		return 0;
+		outLog += std::format("[HeaderTool] : sourceDir {} not exist\n", options.sourceDir.string());
+		return false;
 	}
 
+	if (!std::filesystem::exists(options.ouputFilePath.parent_path()))
+	{
+		outLog += std::format("[HeaderTool] : ouput directory {} not exist\n", options.ouputFilePath.parent_path().string());
+		return false;
+	}
 
-	std::string includesText = GenerateParserInputFile(sourceDir, ouputFilePath);
+	if (options.inputDir.empty())
+		options.inputDir = options.ouputFilePath.parent_path();
 
+	std::error_code ec;
+	std::filesystem::create_directories(options.inputDir, ec);
+	if (ec)
 	{
-		CXString clang_ver = clang_getClangVersion();
-		printf("clang ver: %s\n", clang_getCString(clang_ver));
-		clang_disposeString(clang_ver);
+		outLog += std::format("[HeaderTool] : can't create the intermediate directory {}\n", options.inputDir.string());
+		return false;
 	}
 
+	return true;
+}
+
+std::filesystem::path GetGeneratedFilePath(const Options& options)
+{
+	return options.ouputFilePath.parent_path() / (options.ouputFilePath.stem().string() + ".cpp");
+}
+
+// The includes are parsed from their own file, the generated one overwrites its input otherwise and can't be compared against it.
+// Projects pass their intermediate directory (-O) to keep it out of the source tree.
+std::filesystem::path GetParserInputFilePath(const Options& options)
+{
+	return options.inputDir / (options.ouputFilePath.stem().string() + ".MetaInput.h");
+}
+
+CXTranslationUnit ParseTranslationUnit(CXIndex index, const Options& options)
+{
 	constexpr const char* header_args[] = {
 		"-x",
 		"c++",
@@ -761,16 +1499,116 @@ int main(int argc, char* argv[])
 	for (const auto& arg : header_args) 
 		combinedArgs.push_back(arg);
 
-	for (int i = 1; i < argc; ++i)
+	for (const auto& arg : options.includeArgs)
+		combinedArgs.push_back(arg.c_str());
+
+	// FUNCTION() methods only need their declarations, those are still visited with the bodies skipped
+	const int tu_flags = CXTranslationUnit_SkipFunctionBodies | CXTranslationUnit_VisitImplicitAttributes;
+
+	const std::string inputFilePathStr = GetParserInputFilePath(options).string();
+
+	CXTranslationUnit tu = nullptr;
+	CXErrorCode err = clang_parseTranslationUnit2
+	(
+		index,
+		inputFilePathStr.c_str(),
+		combinedArgs.data(), (int)combinedArgs.size(),
+		nullptr, 0,
+		tu_flags,
+		&tu
+	);
+
+	if (tu == nullptr || err != CXError_Success)
 	{
-		if (std::string(argv[i]).find("-I") == 0)
-			combinedArgs.push_back(argv[i]);
+		printf("tu creation error: %d\n", int(err));
+		return nullptr;
 	}
 
+	return tu;
+}
+
+std::string GetDiagnostics(CXTranslationUnit tu)
+{
+	const int num_diags = clang_getNumDiagnostics(tu);
+	std::string text = std::format("diagnostics ({}):\n", num_diags);
+
+	for (int i = 0; i < num_diags; ++i)
+	{
+		CXDiagnostic diag = clang_getDiagnostic(tu, i);
+		CXString s = clang_formatDiagnostic(diag, clang_defaultDiagnosticDisplayOptions());
+
+		text += clang_getCString(s);
+		text += "\n";
+
+		clang_disposeString(s);
+		clang_disposeDiagnostic(diag);
+	}
+
+	return text;
+}
+
+// parse, AST visit and code emission, in the order they run, the scaling benchmark reads these lines
+struct StageTimes
+{
+	float parse = 0.0f;
+	float visit = 0.0f;
+	float emit = 0.0f;
+};
+
+std::string FormatStageTimes(const StageTimes& times)
+{
+	return std::format("parseTime : {} ms\nvisitTime : {} ms\nemitTime : {} ms\n", times.parse, times.visit, times.emit);
+}
+
+void GenerateRegistry(CXTranslationUnit tu, const Options& options, const std::string& includesText, StageTimes& times)
+{
 	TypeRegistry reg;
 	VisitorData data;
 	data.registry = &reg;
-	
+
+	printf("Meta NameSpace : %s\n", options.nameSpace.c_str());
+
+#ifndef ONLY_PRINT_AST
+	printf("%s", HEADER.c_str());
+#endif // 
+
+	Timer visitTime;
+
+	CXCursor cursor = clang_getTranslationUnitCursor(tu);
+	clang_visitChildren(cursor, VisitTU, &data);
+
+	ResolveFieldTypes(reg);
+	MergeBaseFields(reg);
+
+	times.visit = visitTime.ElapsedMicroseconds() * 0.001f;
+
+	Timer emitTime;
+
+	GenerateCppFileMetaData(includesText, reg, GetGeneratedFilePath(options), options.nameSpace.c_str());
+
+	times.emit = emitTime.ElapsedMicroseconds() * 0.001f;
+}
+
+int RunOnce(const std::vector<std::string>& args)
+{
+	Timer totalTime;
+
+	Options options;
+	std::string log;
+	if (!ParseOptions(args, options, log))
+	{
+		printf("%s", log.c_str());
+		return 0;
+	}
+
+	std::string includesText = GenerateParserInputFile(options.sourceDir, GetParserInputFilePath(options), GetGeneratedFilePath(options));
+
+	{
+		CXString clang_ver = clang_getClangVersion();
+		printf("clang ver: %s\n", clang_getCString(clang_ver));
+		clang_disposeString(clang_ver);
+	}
+
 	{
 		Timer headerParsingTime;
 
@@ -781,65 +1619,447 @@ int main(int argc, char* argv[])
 			return 1;
 		}
 
-		const int tu_flags = CXTranslationUnit_SkipFunctionBodies | CXTranslationUnit_VisitImplicitAttributes;
-
-		CXTranslationUnit tu;
-		CXErrorCode err = clang_parseTranslationUnit2
-		(
-			index,
-			ouputFilePathStr,
-			combinedArgs.data(), (int)combinedArgs.size(),
-			nullptr, 0,
-			tu_flags,
-			&tu
-		);
+		StageTimes times;
+		Timer parseTime;
 
-		if (tu == nullptr || err != CXError_Success)
-		{
-			printf("tu creation error: %d\n", int(err));
+		CXTranslationUnit tu = ParseTranslationUnit(index, options);
+		if (tu == nullptr)
 			return 123;
+
+		times.parse = parseTime.ElapsedMicroseconds() * 0.001f;
+
+		printf("%s", GetDiagnostics(tu).c_str());
+
+		GenerateRegistry(tu, options, includesText, times);
+
+		printf("%s", FormatStageTimes(times).c_str());
+
+		clang_disposeTranslationUnit(tu);
+		tu = nullptr;
+
+		clang_disposeIndex(index);
+		index = nullptr;
+
+		printf("headerParsingTime : %f ms\n", headerParsingTime.ElapsedMilliseconds());
+	}
+
+	printf("totalTime : %f ms\n", totalTime.ElapsedMilliseconds());
+
+	return 0;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Server
+//////////////////////////////////////////////////////////////////////////
+
+// A parsed translation unit kept alive per output file, reparsed only when one of the files it includes changed.
+struct Session
+{
+	std::vector<std::string> includeArgs;
+	std::filesystem::path inputDir;
+	std::string includesText;
+	CXTranslationUnit tu = nullptr;
+	std::unordered_map<std::filesystem::path, std::filesystem::file_time_type> dependencies;
+
+	// the generated file as it was written, a registry edited or deleted behind the server's back is regenerated
+	std::filesystem::file_time_type outputTime;
+	uintmax_t outputSize = 0;
+};
+
+void CollectDependencies(Session& session, const Options& options)
+{
+	struct ClientData
+	{
+		std::unordered_map<std::filesystem::path, std::filesystem::file_time_type>* dependencies;
+		std::filesystem::path generatedFilePath;
+	};
+
+	ClientData clientData = { &session.dependencies, GetGeneratedFilePath(options) };
+	session.dependencies.clear();
+
+	clang_getInclusions(
+		session.tu,
+		[](CXFile file, CXSourceLocation* inclusionStack, unsigned includeLength, CXClientData clientData)
+		{
+			auto* data = (ClientData*)clientData;
+
+			CXString fileName = clang_getFileName(file);
+			std::filesystem::path path = clang_getCString(fileName);
+			clang_disposeString(fileName);
+
+			// written by the server itself, it is checked by IsUpToDate
+			std::error_code ec;
+			if (std::filesystem::equivalent(path, data->generatedFilePath, ec))
+				return;
+
+			(*data->dependencies)[path] = std::filesystem::last_write_time(path, ec);
+		},
+		&clientData);
+}
+
+void RecordGeneratedFile(Session& session, const Options& options)
+{
+	const std::filesystem::path generatedFilePath = GetGeneratedFilePath(options);
+
+	std::error_code ec;
+	session.outputTime = std::filesystem::last_write_time(generatedFilePath, ec);
+	session.outputSize = ec ? 0 : std::filesystem::file_size(generatedFilePath, ec);
+}
+
+bool IsUpToDate(const Session& session, const Options& options, const std::string& includesText)
+{
+	if (!session.tu || session.includeArgs != options.includeArgs || session.inputDir != options.inputDir || session.includesText != includesText)
+		return false;
+
+	// the generated file has to be the one written by the last request
+	{
+		const std::filesystem::path generatedFilePath = GetGeneratedFilePath(options);
+
+		std::error_code ec;
+		if (std::filesystem::last_write_time(generatedFilePath, ec) != session.outputTime || ec)
+			return false;
+
+		const uintmax_t size = std::filesystem::file_size(generatedFilePath, ec);
+		if (ec || size == 0 || size != session.outputSize)
+			return false;
+	}
+
+	for (const auto& [path, time] : session.dependencies)
+	{
+		std::error_code ec;
+		if (std::filesystem::last_write_time(path, ec) != time || ec)
+			return false;
+	}
+
+	return true;
+}
+
+int HandleRequest(CXIndex index, std::map<std::filesystem::path, Session>& sessions, const std::vector<std::string>& args, std::string& outLog)
+{
+	Timer totalTime;
+
+	Options options;
+	if (!ParseOptions(args, options, outLog))
+		return 0;
+
+	Session& session = sessions[std::filesystem::absolute(options.ouputFilePath).lexically_normal()];
+
+	std::string includesText = GenerateParserInputFile(options.sourceDir, GetParserInputFilePath(options), GetGeneratedFilePath(options));
+
+	if (IsUpToDate(session, options, includesText))
+	{
+		outLog += std::format("[HeaderTool] : {} is up to date, totalTime : {} ms\n", options.nameSpace, totalTime.ElapsedMilliseconds());
+		return 0;
+	}
+
+	Timer headerParsingTime;
+
+	StageTimes times;
+	Timer parseTime;
+
+	if (session.tu && session.includeArgs == options.includeArgs && session.inputDir == options.inputDir)
+	{
+		if (clang_reparseTranslationUnit(session.tu, 0, nullptr, clang_defaultReparseOptions(session.tu)) != 0)
+		{
+			clang_disposeTranslationUnit(session.tu);
+			session.tu = nullptr;
 		}
+	}
+	else if (session.tu)
+	{
+		clang_disposeTranslationUnit(session.tu);
+		session.tu = nullptr;
+	}
+
+	if (!session.tu)
+		session.tu = ParseTranslationUnit(index, options);
+
+	if (!session.tu)
+	{
+		outLog += "[HeaderTool] : failed to parse the translation unit\n";
+		return 123;
+	}
+
+	times.parse = parseTime.ElapsedMicroseconds() * 0.001f;
+
+	session.includeArgs = options.includeArgs;
+	session.inputDir = options.inputDir;
+	session.includesText = includesText;
+	CollectDependencies(session, options);
+
+	outLog += GetDiagnostics(session.tu);
+
+	GenerateRegistry(session.tu, options, includesText, times);
+	RecordGeneratedFile(session, options);
+
+	outLog += FormatStageTimes(times);
+
+	outLog += std::format("headerParsingTime : {} ms\n", headerParsingTime.ElapsedMilliseconds());
+	outLog += std::format("totalTime : {} ms\n", totalTime.ElapsedMilliseconds());
 
-		// diagnostics
+	return 0;
+}
+
+// wire format : every string is a uint32_t size followed by its bytes,
+// a request is a uint32_t count followed by the arguments, a reply is an int32_t exit code followed by the log
+bool SendAll(Socket socket, const void* data, size_t size)
+{
+	const char* ptr = (const char*)data;
+
+	while (size > 0)
+	{
+		int sent = (int)send(socket, ptr, (int)size, c_SendFlags);
+		if (sent <= 0)
+			return false;
+
+		ptr += sent;
+		size -= sent;
+	}
+
+	return true;
+}
+
+bool ReceiveAll(Socket socket, void* data, size_t size)
+{
+	char* ptr = (char*)data;
+
+	while (size > 0)
+	{
+		int received = (int)recv(socket, ptr, (int)size, 0);
+		if (received <= 0)
+			return false;
+
+		ptr += received;
+		size -= received;
+	}
+
+	return true;
+}
+
+bool SendString(Socket socket, const std::string& str)
+{
+	uint32_t size = (uint32_t)str.size();
+	return SendAll(socket, &size, sizeof(size)) && SendAll(socket, str.data(), size);
+}
+
+bool ReceiveString(Socket socket, std::string& str)
+{
+	constexpr uint32_t c_MaxStringSize = 64 * 1024 * 1024;
+
+	uint32_t size = 0;
+	if (!ReceiveAll(socket, &size, sizeof(size)) || size > c_MaxStringSize)
+		return false;
+
+	str.resize(size);
+	return ReceiveAll(socket, str.data(), size);
+}
+
+bool InitSockets()
+{
+#if defined(_WIN32)
+	WSADATA wsaData;
+	return WSAStartup(MAKEWORD(2, 2), &wsaData) == 0;
+#else
+	return true;
+#endif
+}
+
+void ShutdownSockets()
+{
+#if defined(_WIN32)
+	WSACleanup();
+#endif
+}
+
+void CloseSocket(Socket socket)
+{
+#if defined(_WIN32)
+	closesocket(socket);
+#else
+	close(socket);
+#endif
+}
+
+bool MakeAddress(const std::string& socketPath, sockaddr_un& addr)
+{
+	addr = {};
+	addr.sun_family = AF_UNIX;
+
+	if (socketPath.size() >= sizeof(addr.sun_path))
+	{
+		printf("[HeaderTool] : socket path %s is too long\n", socketPath.c_str());
+		return false;
+	}
+
+	memcpy(addr.sun_path, socketPath.c_str(), socketPath.size() + 1);
+	return true;
+}
+
+int RunServer(const std::string& socketPath)
+{
+	sockaddr_un addr;
+	if (!MakeAddress(socketPath, addr) || !InitSockets())
+		return 1;
+
+	// a socket file left behind by a server that did not shut down cleanly
+	std::error_code ec;
+	std::filesystem::remove(socketPath, ec);
+
+	Socket server = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (server == c_InvalidSocket || bind(server, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(server, 8) != 0)
+	{
+		printf("[HeaderTool] : unable to listen on %s\n", socketPath.c_str());
+		if (server != c_InvalidSocket)
+			CloseSocket(server);
+		ShutdownSockets();
+		return 1;
+	}
+
+	{
+		CXString clang_ver = clang_getClangVersion();
+		printf("clang ver: %s\n", clang_getCString(clang_ver));
+		clang_disposeString(clang_ver);
+	}
+
+	CXIndex index = clang_createIndex(1, 0);
+	if (index == nullptr)
+	{
+		printf("error\n");
+		CloseSocket(server);
+		ShutdownSockets();
+		return 1;
+	}
+
+	std::map<std::filesystem::path, Session> sessions;
+
+	printf("[HeaderTool] : listening on %s\n", socketPath.c_str());
+
+	bool running = true;
+	while (running)
+	{
+		Socket client = accept(server, nullptr, nullptr);
+		if (client == c_InvalidSocket)
+			continue;
+
+		uint32_t argCount = 0;
+		std::vector<std::string> args;
+		bool valid = ReceiveAll(client, &argCount, sizeof(argCount)) && argCount < 1024;
+
+		for (uint32_t i = 0; valid && i < argCount; i++)
+			valid = ReceiveString(client, args.emplace_back());
+
+		if (valid)
 		{
-			const int num_diags = clang_getNumDiagnostics(tu);
-			printf("diagnostics (%d):\n", num_diags);
+			std::string log;
+			int32_t result = 0;
 
-			for (int i = 0; i < num_diags; ++i)
+			if (args.size() == 1 && args[0] == "--shutdown")
 			{
-				CXDiagnostic diag = clang_getDiagnostic(tu, i);
-				CXString s = clang_formatDiagnostic(diag, clang_defaultDiagnosticDisplayOptions());
+				log = "[HeaderTool] : server stopped\n";
+				running = false;
+			}
+			else
+			{
+				result = HandleRequest(index, sessions, args, log);
+			}
 
-				printf("%s\n", clang_getCString(s));
+			printf("%s", log.c_str());
 
-				clang_disposeString(s);
-				clang_disposeDiagnostic(diag);
-			}
+			if (SendAll(client, &result, sizeof(result)))
+				SendString(client, log);
 		}
 
-		printf("Meta NameSpace : %s\n", nameSpace);
-		
-#ifndef ONLY_PRINT_AST
-		printf("%s", HEADER.c_str());
-#endif // 
+		CloseSocket(client);
+	}
 
+	for (auto& [path, session] : sessions)
+	{
+		if (session.tu)
+			clang_disposeTranslationUnit(session.tu);
+	}
 
-		CXCursor cursor = clang_getTranslationUnitCursor(tu);
+	clang_disposeIndex(index);
 
-		clang_visitChildren(cursor, VisitTU, &data);
+	CloseSocket(server);
+	ShutdownSockets();
+	std::filesystem::remove(socketPath, ec);
 
-		clang_disposeTranslationUnit(tu);
-		tu = nullptr;
+	return 0;
+}
 
-		clang_disposeIndex(index);
-		index = nullptr;
+// the server resolves relative paths against its own working directory, which is not the one of the client
+std::vector<std::string> MakePathArgsAbsolute(const std::vector<std::string>& args)
+{
+	std::vector<std::string> result = args;
 
-		printf("headerParsingTime : %f ms\n", headerParsingTime.ElapsedMilliseconds());
+	for (size_t i = 0; i < result.size(); i++)
+	{
+		if (i < 2)
+			result[i] = std::filesystem::absolute(result[i]).lexically_normal().string();
+		else if (i > 2 && result[i].size() > 2 && (result[i].find("-I") == 0 || result[i].find("-O") == 0))
+			result[i] = result[i].substr(0, 2) + std::filesystem::absolute(result[i].substr(2)).lexically_normal().string();
 	}
 
-	GenerateCppFileMetaData(includesText, reg, ouputFilePath.parent_path() / (ouputFilePath.stem().string() + ".cpp"), nameSpace);
+	return result;
+}
 
-	printf("totalTime : %f ms\n", totalTime.ElapsedMilliseconds());
+// Forwards the run to a server, without one listening on 'socketPath' the run happens in this process.
+int RunClient(const std::string& socketPath, const std::vector<std::string>& localArgs)
+{
+	const bool isShutdown = localArgs.size() == 1 && localArgs[0] == "--shutdown";
+	const std::vector<std::string> args = isShutdown ? localArgs : MakePathArgsAbsolute(localArgs);
 
-	return 0;
-}
\ No newline at end of file
+	sockaddr_un addr;
+	if (!MakeAddress(socketPath, addr) || !InitSockets())
+		return isShutdown ? 0 : RunOnce(args);
+
+	Socket client = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (client == c_InvalidSocket || connect(client, (sockaddr*)&addr, sizeof(addr)) != 0)
+	{
+		if (client != c_InvalidSocket)
+			CloseSocket(client);
+		ShutdownSockets();
+
+		if (isShutdown)
+			return 0;
+
+		printf("[HeaderTool] : no server listening on %s, running in process\n", socketPath.c_str());
+		return RunOnce(args);
+	}
+
+	uint32_t argCount = (uint32_t)args.size();
+	bool valid = SendAll(client, &argCount, sizeof(argCount));
+
+	for (size_t i = 0; valid && i < args.size(); i++)
+		valid = SendString(client, args[i]);
+
+	int32_t result = 1;
+	std::string log;
+	valid = valid && ReceiveAll(client, &result, sizeof(result)) && ReceiveString(client, log);
+
+	CloseSocket(client);
+	ShutdownSockets();
+
+	if (!valid)
+	{
+		printf("[HeaderTool] : lost connection to the server on %s\n", socketPath.c_str());
+		return 1;
+	}
+
+	printf("%s", log.c_str());
+
+	return result;
+}
+
+int main(int argc, char* argv[])
+{
+	std::vector<std::string> args(argv + 1, argv + argc);
+
+	if (args.size() >= 2 && args[0] == "--server")
+		return RunServer(args[1]);
+
+	if (args.size() >= 2 && args[0] == "--client")
+		return RunClient(args[1], std::vector<std::string>(args.begin() + 2, args.end()));
+
+	return RunOnce(args);
+}
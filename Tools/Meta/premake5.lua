@@ -1,6 +1,20 @@
 
+newoption {
+    trigger = "meta-server",
+    value = "socket",
+    description = "Send header tool runs to a 'Meta --server <socket>' process, falls back to a one-shot run when none is listening",
+}
+
 function RunHeaderTool(args)
     local metaHeaderToolPath = path.join(binOutputDir, "Meta");
+
+    -- the parser input file goes to the intermediates of the project, not next to the generated file in its sources
+    args = args .. " -O%{cfg.objdir}"
+
+    if _OPTIONS["meta-server"] then
+        return string.format("%s --client %s %s", metaHeaderToolPath, _OPTIONS["meta-server"], args)
+    end
+
     return string.format("%s %s", metaHeaderToolPath, args)
 end
 
@@ -43,3 +57,138 @@ project "Meta"
     {
         "libclang",
     }
+
+    filter "system:windows"
+        links { "ws2_32" }
+    filter {}
+
+-------------------------------------------------------------------------------------
+-- meta-benchmark : how the header tool scales with the size of a project
+-- premake5 --file=premake.lua meta-benchmark --meta-headers=1,8,32 --meta-types=16 --meta-fields=8
+-------------------------------------------------------------------------------------
+newoption { trigger = "meta-headers", value = "N[,N...]", description = "meta-benchmark : generated headers" }
+newoption { trigger = "meta-types",   value = "M[,M...]", description = "meta-benchmark : TYPE() structs per header" }
+newoption { trigger = "meta-fields",  value = "K[,K...]", description = "meta-benchmark : PROPERTY() fields per struct" }
+newoption { trigger = "meta-runs",    value = "count",    description = "meta-benchmark : runs per configuration, the median is reported" }
+newoption { trigger = "meta-config",  value = "config",   description = "meta-benchmark : build configuration of the Meta executable, Release by default" }
+newoption { trigger = "meta-csv",     value = "file",     description = "meta-benchmark : append the results to a CSV file" }
+
+local function ParseList(value, default)
+    local list = {}
+    for n in string.gmatch(value or default, "%d+") do
+        table.insert(list, tonumber(n))
+    end
+    return list
+end
+
+-- each field type comes with its stacked attributes, struct n > 0 also nests struct n - 1
+local c_BenchmarkFields = {
+    { type = "float",        attributes = { "PROPERTY(Meta::UI::Slider)", "PROPERTY(Meta::Range(0.0f, 10.0f))" } },
+    { type = "Math::float3", attributes = { "PROPERTY(Meta::Color(0.2f, 0.3f, 0.7f, 1.0f))", "PROPERTY(Meta::UI::Drag)" } },
+    { type = "int",          attributes = { "PROPERTY(Meta::UI::Drag)" } },
+    { type = "bool",         attributes = { "PROPERTY(Meta::UI::Text)" } },
+    { type = "uint32_t",     attributes = { "PROPERTY()" } },
+}
+
+function GenerateBenchmarkHeaders(dir, headerCount, typeCount, fieldCount)
+    os.rmdir(dir)
+    os.mkdir(dir)
+
+    io.writefile(path.join(dir, "Common.h"), '#pragma once\n\n#include "Core/Core.h"\n\nMetaHeader(MetaBenchmark)\n')
+
+    for h = 0, headerCount - 1 do
+        local lines = { "#pragma once", "", '#include "Common.h"', "", "namespace MetaBenchmark {", "" }
+
+        for t = 0, typeCount - 1 do
+            table.insert(lines, string.format("    struct TYPE() Type%d_%d", h, t))
+            table.insert(lines, "    {")
+
+            for f = 0, fieldCount - 1 do
+                local field = c_BenchmarkFields[f % #c_BenchmarkFields + 1]
+                for _, attribute in ipairs(field.attributes) do
+                    table.insert(lines, "        " .. attribute)
+                end
+                table.insert(lines, string.format("        %s field%d;", field.type, f))
+                table.insert(lines, "")
+            end
+
+            if t > 0 then
+                table.insert(lines, "        PROPERTY()")
+                table.insert(lines, string.format("        Type%d_%d nested;", h, t - 1))
+            end
+
+            table.insert(lines, "    };")
+            table.insert(lines, "")
+        end
+
+        table.insert(lines, "}")
+        io.writefile(path.join(dir, string.format("Header%d.h", h)), table.concat(lines, "\n") .. "\n")
+    end
+end
+
+local function Median(values)
+    table.sort(values)
+    return values[math.floor((#values + 1) / 2)] or 0
+end
+
+newaction {
+    trigger = "meta-benchmark",
+    description = "Run the Meta header tool over generated headers and report its parse, visit and emit times",
+
+    execute = function()
+        local system = os.host():gsub("^%l", string.upper)
+        local config = _OPTIONS["meta-config"] or "Release"
+        local metaPath = path.join(HE, "Build", system .. "-x86_64", config, "Bin", "Meta")
+        local dir = path.join(HE, "Build", "MetaBenchmark")
+        local runs = tonumber(_OPTIONS["meta-runs"] or "5")
+
+        local includes = ""
+        for _, name in ipairs({ "Core", "glm", "nvrhi", "tracy", "taskflow", "magic_enum" }) do
+            includes = includes .. " -I" .. IncludeDir[name]:gsub("%%{HE}", HE)
+        end
+
+        local csv = nil
+        if _OPTIONS["meta-csv"] then
+            local exists = os.isfile(_OPTIONS["meta-csv"])
+            csv = io.open(_OPTIONS["meta-csv"], "a")
+            if not exists then
+                csv:write("headers,types,fields,parseMs,visitMs,emitMs,totalMs\n")
+            end
+        end
+
+        print(string.format("%8s %8s %8s %12s %12s %12s %12s", "headers", "types", "fields", "parse ms", "visit ms", "emit ms", "total ms"))
+
+        for _, headerCount in ipairs(ParseList(_OPTIONS["meta-headers"], "1,8,32")) do
+            for _, typeCount in ipairs(ParseList(_OPTIONS["meta-types"], "16")) do
+                for _, fieldCount in ipairs(ParseList(_OPTIONS["meta-fields"], "8")) do
+                    GenerateBenchmarkHeaders(dir, headerCount, typeCount, fieldCount)
+
+                    local command = string.format("%s %s %s MetaBenchmark%s", metaPath, dir, path.join(dir, "Meta.cpp"), includes)
+                    local times = { parseTime = {}, visitTime = {}, emitTime = {}, totalTime = {} }
+
+                    for run = 1, runs do
+                        local output, code = os.outputof(command)
+                        if code ~= 0 then
+                            error(string.format("'%s' failed (%s) :\n%s", command, tostring(code), output))
+                        end
+
+                        for key, values in pairs(times) do
+                            table.insert(values, tonumber(output:match(key .. " : ([%d%.]+) ms")) or 0)
+                        end
+                    end
+
+                    local parse, visit, emit, total = Median(times.parseTime), Median(times.visitTime), Median(times.emitTime), Median(times.totalTime)
+                    print(string.format("%8d %8d %8d %12.2f %12.2f %12.2f %12.2f", headerCount, typeCount, fieldCount, parse, visit, emit, total))
+
+                    if csv then
+                        csv:write(string.format("%d,%d,%d,%.3f,%.3f,%.3f,%.3f\n", headerCount, typeCount, fieldCount, parse, visit, emit, total))
+                    end
+                end
+            end
+        end
+
+        if csv then
+            csv:close()
+        end
+    end
+}
@@ -50,3 +50,6 @@ workspace "StructToUI"
 
     group("Editor")
     AddModules("Source/Editor")
+
+    group("Benchmarks")
+    AddModules("Source/Benchmarks")